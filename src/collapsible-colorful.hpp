@@ -12,16 +12,19 @@
 #include "ftxui/util/ref.hpp"  // for Ref, ConstStringRef
 
 // almost copy-pased from ftxui::Collapsible
-ftxui::Component CollapsibleColorful(ftxui::ConstStringRef label, ftxui::Component child, ftxui::Color textColor = ftxui::Color::Default, ftxui::Ref<bool> show = false)
+// textColor is evaluated on every render, so the label follows model changes
+// onFocused is called whenever the label is rendered focused; the label checkbox is ChildAt(0)->ChildAt(0)
+ftxui::Component CollapsibleColorful(ftxui::ConstStringRef label, ftxui::Component child, std::function<ftxui::Color()> textColor = nullptr, ftxui::Ref<bool> show = false,
+                                     std::function<void()> onFocused = nullptr)
 {
   using namespace ftxui;
 
   class Impl : public ComponentBase {
    public:
-    Impl(ConstStringRef label, Component child, Ref<bool> show, ftxui::Color textColor) : show_(show), textColor_(textColor) 
+    Impl(ConstStringRef label, Component child, Ref<bool> show, std::function<ftxui::Color()> textColor, std::function<void()> onFocused) : show_(show)
     {
       CheckboxOption opt;
-      opt.transform = [textColor_ = this->textColor_](EntryState s) {   // NOLINT
+      opt.transform = [textColor_ = std::move(textColor), onFocused = std::move(onFocused)](EntryState s) {   // NOLINT
         auto prefix = text(s.state ? "▼ " : "▶ ");  // NOLINT
         auto t = text(s.label);
         if (s.active) {
@@ -29,9 +32,11 @@ ftxui::Component CollapsibleColorful(ftxui::ConstStringRef label, ftxui::Compone
         }
         if (s.focused) {
           t |= inverted;
+          if (onFocused)
+            onFocused();
         }
-        if (textColor_ != ftxui::Color::Default)        {
-            t |= ftxui::color(textColor_);
+        if (ftxui::Color color = textColor_ ? textColor_() : ftxui::Color::Default; color != ftxui::Color::Default)        {
+            t |= ftxui::color(color);
         }
         return hbox({prefix, t});
       };
@@ -41,8 +46,7 @@ ftxui::Component CollapsibleColorful(ftxui::ConstStringRef label, ftxui::Compone
       }));
     }
     Ref<bool> show_;
-    ftxui::Color textColor_ = ftxui::Color::Default;
   };
 
-  return Make<Impl>(std::move(label), std::move(child), show, textColor);
+  return Make<Impl>(std::move(label), std::move(child), show, std::move(textColor), std::move(onFocused));
 }
@@ -1,30 +1,79 @@
 #include "config.h"
 #include "argh.h"
 #include "model.h"
+#include <algorithm>
 #include <iostream>
 
+static std::size_t getSize(const argh::parser& args, const char* name, std::size_t defaultValue = 0)
+{
+    std::size_t value = defaultValue;
+    args(name) >> value;
+    return value;
+}
+
+// "--name=value", or "--name value" where the value is the positional argument at the given index
+static std::string getString(const argh::parser& args, const char* name, std::size_t positional)
+{
+    if (std::string value = args(name).str(); !value.empty())
+        return value;
+    return args[name] ? args[positional] : std::string();
+}
 
 void Config::showUsageMessage()
 {
     std::cout << "Usage: "
-              << "  include-walker <compilation log file> [--no-std] [--auto-expand] [--find='substring']" << std::endl;
+              << "  include-walker <compilation log file> [--no-std] [--auto-expand] [--find='substring'] [--includers='header'] [--redundant] [--impact [--top=N]]" << std::endl
+              << "  include-walker <compilation log file> --time-trace=<trace file or directory> [--headless] [--top=N]" << std::endl
+              << "  include-walker <compilation log file> --serve=<socket> [--no-std]" << std::endl
+              << "  include-walker <compilation log file> --aggregate [--no-std] [--top=N]" << std::endl
+              << "  include-walker <compilation log file> --pch[=max headers] [--pch-size=max includes in pch]" << std::endl
+              << "  include-walker --diff <old compilation log> <new compilation log> [--no-std]" << std::endl;
 }
 
 Config::Config(argh::parser args)
     : m_ignoreStd(args["--no-std"])
-    , m_showUsage(args[{"--help", "--usage"}] || args.size() < 2)
+    , m_showUsage(args[{"--help", "--usage"}] || args.size() < (args["--diff"] ? 3 : 2))
     , m_autoExpand(args["--auto-expand"])
     , m_simplifyPath(args["--simplify"])
+    , m_diff(args["--diff"])
     , m_inputFile(args[1]/*first positional*/)
+    , m_diffInputFile(m_diff ? args[2] : std::string())
+    , m_includersOf(args("--includers").str())
+    , m_pchMaxHeaders(getSize(args, "--pch"))
+    , m_pchMaxIncludes(getSize(args, "--pch-size"))
+    , m_pch(args["--pch"] || m_pchMaxHeaders || m_pchMaxIncludes)
+    , m_redundant(args["--redundant"])
+    , m_impact(args["--impact"])
+    , m_timeTrace(args("--time-trace").str())
+    , m_headless(args["--headless"])
+    , m_top(getSize(args, "--top", 50))
+    , m_aggregate(args["--aggregate"])
+    , m_serveSocket(getString(args, "--serve", 2))
     , m_findNormalized(args("--find").str())
 {
     std::cout << "Parsing compilation log file: " << m_inputFile << std::endl;
+    if (m_diff)
+        std::cout << " + diff against: " << m_diffInputFile << std::endl;
     if (m_ignoreStd)
         std::cout << " + ignore std headers" << std::endl;
     if (m_autoExpand)
         std::cout << " + auto-expand tree with loops" << std::endl;
     if (m_simplifyPath)
         std::cout << " + simplify path" << std::endl;
+    if (!m_includersOf.empty())
+        std::cout << " + list includers of: '" << m_includersOf << "'" << std::endl;
+    if (m_pch)
+        std::cout << " + recommend precompiled headers" << std::endl;
+    if (m_redundant)
+        std::cout << " + report redundant includes" << std::endl;
+    if (m_impact)
+        std::cout << " + rank headers by rebuild impact" << std::endl;
+    if (!m_serveSocket.empty())
+        std::cout << " + serve queries on: " << m_serveSocket << std::endl;
+    if (m_aggregate)
+        std::cout << " + aggregate only, constant memory" << std::endl;
+    if (!m_timeTrace.empty())
+        std::cout << " + time traces: " << m_timeTrace << std::endl;
     if (!m_findNormalized.empty())
         std::cout << " + search for: '" << m_findNormalized << "'" << std::endl;
 
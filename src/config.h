@@ -10,13 +10,28 @@ struct Config
     const bool        m_showUsage  = false;
     const bool        m_autoExpand = false;  // auto-expand cycles
     const bool        m_simplifyPath = true; // cut longest common substring from path
+    const bool        m_diff = false;        // compare m_inputFile (old) against m_diffInputFile (new)
     const std::string m_inputFile;
+    const std::string m_diffInputFile;
+    const std::string m_includersOf;         // print who includes this header and exit
+    const std::size_t m_pchMaxHeaders = 0;   // recommend precompiled headers: budget in headers...
+    const std::size_t m_pchMaxIncludes = 0;  // ... and/or in include events inside the pch, 0 - no limit
+    const bool        m_pch = false;
+    const bool        m_redundant = false;   // report includes already brought in by an earlier sibling
+    const bool        m_impact = false;      // rank headers by the modules to rebuild when they change
+    const std::string m_timeTrace;           // clang -ftime-trace file or directory, weights the tree by time
+    const bool        m_headless = false;    // print reports without the UI
+    const std::size_t m_top = 50;            // length of the rankings
+    const bool        m_aggregate = false;   // stream solution-wide aggregates, no include trees are kept
+    const std::string m_serveSocket;         // answer JSON queries on this Unix domain socket
     std::string m_findNormalized;            // try finding this substring, expand the tree if success
 
     Config(argh::parser args);
 
     static void showUsageMessage();
 
+    bool isHeadless() const { return m_headless || !m_includersOf.empty() || m_pch || m_redundant || m_impact; }
+
     Config(Config&) = delete;
     Config& operator=(Config&) = delete;
 };
@@ -0,0 +1,136 @@
+#include "includeAggregator.h"
+#include <algorithm>
+
+IncludeAggregator::IncludeAggregator(std::size_t maxChains)
+    : m_maxChains(maxChains)
+{
+}
+
+void IncludeAggregator::projectStarted(MsvcParser::ProjectId projectId, const std::string& projectName)
+{
+    m_activeProjects[projectId] = ActiveProject{ projectName, {}, 0, {} };
+    ++m_projectCount;
+}
+
+void IncludeAggregator::moduleStarted(MsvcParser::ProjectId projectId, const std::string& moduleName)
+{
+    ActiveProject& project = m_activeProjects[projectId];
+    closeIncludes(project, 0);
+    project.m_module = moduleName;
+    project.m_moduleSerial = ++m_moduleCount;
+}
+
+void IncludeAggregator::headerIncluded(MsvcParser::ProjectId projectId, int level, const std::string& headerName)
+{
+    ActiveProject& project = m_activeProjects[projectId];
+    HeaderId id = intern(headerName);
+
+    // the new header is a child of the include open at (level - 1), deeper ones are complete
+    closeIncludes(project, static_cast<std::size_t>(std::max(level, 0)));
+
+    HeaderStats& stats = m_headers[id];
+    ++stats.m_includeCount;
+    ++m_includeCount;
+    if (stats.m_lastModule != project.m_moduleSerial)
+    {
+        stats.m_lastModule = project.m_moduleSerial;
+        ++stats.m_moduleCount;
+    }
+
+    auto ancestor = std::find_if(project.m_includes.begin(), project.m_includes.end(), [id](const Frame& frame) { return frame.m_id == id; });
+    if (ancestor != project.m_includes.end() && ++stats.m_cycleCount == 1)
+    {
+        Chain cycle{ project.m_name, project.m_module, {} };
+        for (auto it = ancestor; it != project.m_includes.end(); ++it)
+            cycle.m_headers.push_back(it->m_id);
+        cycle.m_headers.push_back(id);
+        m_cycles.push_back(std::move(cycle));
+    }
+
+    project.m_includes.push_back(Frame{ id });
+}
+
+void IncludeAggregator::projectDone(MsvcParser::ProjectId projectId)
+{
+    auto it = m_activeProjects.find(projectId);
+    if (it == m_activeProjects.end())
+        return;
+
+    closeIncludes(it->second, 0);
+    m_activeProjects.erase(it);
+}
+
+IncludeAggregator::HeaderId IncludeAggregator::intern(const std::string& headerName)
+{
+    if (auto it = m_idsBySpelling.find(headerName); it != m_idsBySpelling.end())
+        return it->second;
+
+    auto [it, isInserted] = m_idsByNormalized.emplace(Model::normalizePath(headerName), static_cast<HeaderId>(m_headers.size()));
+    if (isInserted)
+        m_headers.push_back(HeaderStats{ headerName });
+
+    m_idsBySpelling.emplace(headerName, it->second);
+    return it->second;
+}
+
+void IncludeAggregator::closeIncludes(ActiveProject& project, std::size_t openCount)
+{
+    while (project.m_includes.size() > openCount)
+    {
+        Frame frame = project.m_includes.back();
+        project.m_includes.pop_back();
+
+        if (frame.m_beneath == 0)
+            rankChain(project, frame);
+
+        HeaderStats& stats = m_headers[frame.m_id];
+        stats.m_beneathTotal += frame.m_beneath;
+        stats.m_beneathMax = std::max(stats.m_beneathMax, frame.m_beneath);
+
+        if (!project.m_includes.empty())
+            project.m_includes.back().m_beneath += frame.m_beneath + 1;
+    }
+}
+
+void IncludeAggregator::rankChain(const ActiveProject& project, const Frame& leaf)
+{
+    // project.m_includes holds the leaf's ancestors
+    const std::size_t depth = project.m_includes.size() + 1;
+    if (m_maxChains == 0 || (m_deepestChains.size() == m_maxChains && depth <= m_deepestChains.top().m_headers.size()))
+        return;
+
+    Chain chain{ project.m_name, project.m_module, {} };
+    chain.m_headers.reserve(depth);
+    for (const Frame& frame : project.m_includes)
+        chain.m_headers.push_back(frame.m_id);
+    chain.m_headers.push_back(leaf.m_id);
+
+    if (!m_chainHashes.insert(chainHash(chain.m_headers)).second)
+        return;     // the same chain from another module
+
+    m_deepestChains.push(std::move(chain));
+    if (m_deepestChains.size() > m_maxChains)
+    {
+        m_chainHashes.erase(chainHash(m_deepestChains.top().m_headers));
+        m_deepestChains.pop();
+    }
+}
+
+Model::Hash IncludeAggregator::chainHash(const std::vector<HeaderId>& headers)
+{
+    Model::Hash hash = headers.size();
+    for (HeaderId id : headers)
+        hash = Model::combineHash(hash, id);
+    return hash;
+}
+
+std::vector<IncludeAggregator::Chain> IncludeAggregator::deepestChains() const
+{
+    std::vector<Chain> chains;
+    chains.reserve(m_deepestChains.size());
+    for (auto queue = m_deepestChains; !queue.empty(); queue.pop())
+        chains.push_back(queue.top());
+
+    std::reverse(chains.begin(), chains.end());
+    return chains;
+}
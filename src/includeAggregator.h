@@ -0,0 +1,93 @@
+#pragma once
+#include <cstdint>
+#include <queue>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "model.h"
+#include "msvcParser.h"
+
+// Solution-wide include statistics, folded into per-header counters as the log streams by.
+// Only a stack of the open includes is kept per active project instead of the include trees,
+// so memory is bounded by the distinct headers rather than by the include events.
+class IncludeAggregator : public MsvcParser::Listener
+{
+public:
+    using HeaderId = Model::HeaderId;
+
+    struct HeaderStats
+    {
+        std::string m_name;                 // the first spelling seen in the log
+        std::uint64_t m_includeCount = 0;   // include events
+        std::uint64_t m_moduleCount = 0;    // modules including the header
+        std::uint64_t m_beneathTotal = 0;   // include events beneath the header, over all occurrences
+        std::uint64_t m_beneathMax = 0;     // ... beneath the largest occurrence
+        std::uint64_t m_cycleCount = 0;     // occurrences below another occurrence of the same header
+        std::uint64_t m_lastModule = 0;     // serial of the last module including the header
+    };
+
+    struct Chain
+    {
+        std::string m_project;
+        std::string m_module;
+        std::vector<HeaderId> m_headers;    // outermost first
+    };
+
+    explicit IncludeAggregator(std::size_t maxChains);
+
+    void projectStarted(MsvcParser::ProjectId projectId, const std::string& projectName) override;
+    void moduleStarted(MsvcParser::ProjectId projectId, const std::string& moduleName) override;
+    void headerIncluded(MsvcParser::ProjectId projectId, int level, const std::string& headerName) override;
+    void projectDone(MsvcParser::ProjectId projectId) override;
+
+    const std::vector<HeaderStats>& headers() const { return m_headers; }
+    const std::vector<Chain>& cycles() const { return m_cycles; }     // the first cycle of every header
+    std::vector<Chain> deepestChains() const;                         // deepest first
+
+    std::uint64_t projectCount() const { return m_projectCount; }
+    std::uint64_t moduleCount() const { return m_moduleCount; }
+    std::uint64_t includeCount() const { return m_includeCount; }
+
+private:
+    struct Frame
+    {
+        HeaderId m_id = 0;
+        std::uint64_t m_beneath = 0;
+    };
+
+    struct ActiveProject
+    {
+        std::string m_name;
+        std::string m_module;
+        std::uint64_t m_moduleSerial = 0;
+        std::vector<Frame> m_includes;      // the include stack
+    };
+
+    struct DeeperFirst
+    {
+        bool operator()(const Chain& left, const Chain& right) const { return left.m_headers.size() > right.m_headers.size(); }
+    };
+
+    const std::size_t m_maxChains;
+
+    std::unordered_map<MsvcParser::ProjectId, ActiveProject> m_activeProjects;
+    std::unordered_map<std::string, HeaderId> m_idsBySpelling;     // saves normalizing every include note
+    std::unordered_map<std::string, HeaderId> m_idsByNormalized;
+    std::vector<HeaderStats> m_headers;
+    std::vector<Chain> m_cycles;
+
+    // min-heap of the deepest chains, the shallowest on top; chains with the same headers are kept once
+    std::priority_queue<Chain, std::vector<Chain>, DeeperFirst> m_deepestChains;
+    std::unordered_set<Model::Hash> m_chainHashes;
+
+    std::uint64_t m_projectCount = 0;
+    std::uint64_t m_moduleCount = 0;
+    std::uint64_t m_includeCount = 0;
+
+    HeaderId intern(const std::string& headerName);
+    void closeIncludes(ActiveProject& project, std::size_t openCount);
+    void rankChain(const ActiveProject& project, const Frame& leaf);
+    static Model::Hash chainHash(const std::vector<HeaderId>& headers);
+};
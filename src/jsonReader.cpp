@@ -0,0 +1,210 @@
+#include "jsonReader.h"
+#include "error.h"
+#include "utf8.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+JsonReader::JsonReader(std::istream& input)
+    : m_input(input)
+    , m_buffer(k_bufferSize)
+{
+}
+
+int JsonReader::peek()
+{
+    if (m_position == m_size)
+    {
+        m_input.read(m_buffer.data(), m_buffer.size());
+        m_size = static_cast<std::size_t>(m_input.gcount());
+        m_position = 0;
+        if (m_size == 0)
+            return EOF;
+    }
+
+    return static_cast<unsigned char>(m_buffer[m_position]);
+}
+
+int JsonReader::get()
+{
+    int c = peek();
+    if (c != EOF)
+        ++m_position;
+    return c;
+}
+
+void JsonReader::skipSeparators()
+{
+    for (int c = peek(); c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == ',' || c == ':'; c = peek())
+        ++m_position;
+}
+
+void JsonReader::expectLiteral(const char* literal)
+{
+    for (const char* expected = literal; *expected; ++expected)
+        if (get() != *expected)
+            throw Error("Error: malformed JSON, expected '", literal, "'");
+}
+
+JsonReader::Token JsonReader::valueRead(Token token)
+{
+    // a complete value inside an object is followed by the next key
+    m_expectKey = !m_containers.empty() && m_containers.back();
+    return token;
+}
+
+JsonReader::Token JsonReader::next()
+{
+    skipSeparators();
+    int c = get();
+    switch (c)
+    {
+    case EOF:
+        return Token::End;
+
+    case '{':
+        m_containers.push_back(true);
+        m_expectKey = true;
+        return Token::BeginObject;
+
+    case '[':
+        m_containers.push_back(false);
+        m_expectKey = false;
+        return Token::BeginArray;
+
+    case '}':
+    case ']':
+        if (m_containers.empty() || m_containers.back() != (c == '}'))
+            throw Error("Error: malformed JSON, unbalanced '", std::string(1, static_cast<char>(c)), "'");
+        m_containers.pop_back();
+        return valueRead(c == '}' ? Token::EndObject : Token::EndArray);
+
+    case '"':
+        readString();
+        if (m_expectKey)
+        {
+            m_expectKey = false;
+            return Token::Key;
+        }
+        return valueRead(Token::String);
+
+    case 't':
+        expectLiteral("rue");
+        m_boolean = true;
+        return valueRead(Token::Bool);
+
+    case 'f':
+        expectLiteral("alse");
+        m_boolean = false;
+        return valueRead(Token::Bool);
+
+    case 'n':
+        expectLiteral("ull");
+        return valueRead(Token::Null);
+
+    default:
+        if (c == '-' || (c >= '0' && c <= '9'))
+        {
+            --m_position;   // step back, c is still in the buffer
+            readNumber();
+            return valueRead(Token::Number);
+        }
+        throw Error("Error: malformed JSON, unexpected character '", std::string(1, static_cast<char>(c)), "'");
+    }
+}
+
+void JsonReader::skipValue()
+{
+    skip(next());
+}
+
+void JsonReader::skip(Token first)
+{
+    if (first != Token::BeginObject && first != Token::BeginArray)
+        return;
+
+    for (std::size_t endDepth = depth() - 1; depth() > endDepth; )
+        if (next() == Token::End)
+            throw Error("Error: malformed JSON, unexpected end of input");
+}
+
+void JsonReader::readString()
+{
+    m_string.clear();
+    for (;;)
+    {
+        int c = get();
+        if (c == EOF)
+            throw Error("Error: malformed JSON, unterminated string");
+        if (c == '"')
+            return;
+        if (c != '\\')
+        {
+            m_string.push_back(static_cast<char>(c));
+            continue;
+        }
+
+        switch (int escaped = get())
+        {
+        case 'b': m_string.push_back('\b'); break;
+        case 'f': m_string.push_back('\f'); break;
+        case 'n': m_string.push_back('\n'); break;
+        case 'r': m_string.push_back('\r'); break;
+        case 't': m_string.push_back('\t'); break;
+        case 'u':
+        {
+            unsigned codePoint = readHex4();
+            if (codePoint >= 0xD800 && codePoint < 0xDC00 && peek() == '\\')
+            {
+                // surrogate pair
+                get();
+                if (get() != 'u')
+                    throw Error("Error: malformed JSON, broken surrogate pair");
+                unsigned low = readHex4();
+                codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+            }
+            char encoded[4];
+            m_string.append(encoded, appendUtf8(codePoint, encoded));
+            break;
+        }
+        case EOF:
+            throw Error("Error: malformed JSON, unterminated string");
+        default:
+            m_string.push_back(static_cast<char>(escaped));   // '"', '\\', '/'
+        }
+    }
+}
+
+unsigned JsonReader::readHex4()
+{
+    unsigned value = 0;
+    for (int i = 0; i < 4; ++i)
+    {
+        int c = get();
+        value <<= 4;
+        if (c >= '0' && c <= '9')
+            value |= c - '0';
+        else if (c >= 'a' && c <= 'f')
+            value |= c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F')
+            value |= c - 'A' + 10;
+        else
+            throw Error("Error: malformed JSON, bad \\u escape");
+    }
+    return value;
+}
+
+void JsonReader::readNumber()
+{
+    char digits[64];
+    std::size_t length = 0;
+    for (int c = peek(); c > 0 && std::strchr("+-0123456789.eE", c); c = peek())
+    {
+        if (length + 1 < sizeof(digits))
+            digits[length++] = static_cast<char>(c);
+        ++m_position;
+    }
+
+    digits[length] = '\0';
+    m_number = std::strtod(digits, nullptr);
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <istream>
+#include <string>
+#include <vector>
+
+// Pull parser over a JSON stream: returns one token at a time and never builds a document,
+// so memory does not depend on the input size. Object keys are reported as Token::Key.
+class JsonReader
+{
+public:
+    enum class Token
+    {
+        BeginObject,
+        EndObject,
+        BeginArray,
+        EndArray,
+        Key,
+        String,
+        Number,
+        Bool,
+        Null,
+        End,        // end of input
+    };
+
+    explicit JsonReader(std::istream& input);
+
+    JsonReader(const JsonReader&) = delete;
+    JsonReader& operator=(const JsonReader&) = delete;
+
+    Token next();
+    void skipValue();           // skips the value following a Key, including nested containers
+    void skip(Token first);     // skips the rest of a value whose first token was just read
+
+    const std::string& string() const { return m_string; }  // Key or String
+    double number() const { return m_number; }
+    bool boolean() const { return m_boolean; }
+    std::size_t depth() const { return m_containers.size(); }
+
+private:
+    static constexpr std::size_t k_bufferSize = 1 << 16;
+
+    std::istream& m_input;
+    std::vector<char> m_buffer;
+    std::size_t m_position = 0;
+    std::size_t m_size = 0;
+
+    std::vector<bool> m_containers;     // true for objects
+    bool m_expectKey = false;
+
+    std::string m_string;
+    double m_number = 0;
+    bool m_boolean = false;
+
+    int peek();
+    int get();
+    void skipSeparators();
+    void expectLiteral(const char* literal);
+    void readString();
+    void readNumber();
+    unsigned readHex4();
+    Token valueRead(Token token);
+};
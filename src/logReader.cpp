@@ -0,0 +1,223 @@
+#include "logReader.h"
+#include "error.h"
+#include "utf8.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define LOG_READER_SSE2 1
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    #include <arm_neon.h>
+    #define LOG_READER_NEON 1
+#endif
+
+namespace
+{
+    constexpr std::size_t k_simdUnits = 16;     // code units per vector step
+
+    unsigned loadUnit(const char* units, std::size_t index)
+    {
+        return static_cast<unsigned char>(units[2 * index]) | (static_cast<unsigned char>(units[2 * index + 1]) << 8);
+    }
+
+    // copies the leading ASCII run, k_simdUnits at a time; returns the number of units copied
+    std::size_t copyAscii(const char* units, std::size_t count, char* out)
+    {
+        std::size_t i = 0;
+#if defined(LOG_READER_SSE2)
+        const __m128i nonAsciiBits = _mm_set1_epi16(static_cast<short>(0xFF80));
+        for (; i + k_simdUnits <= count; i += k_simdUnits)
+        {
+            __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(units + 2 * i));
+            __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(units + 2 * i + 16));
+            __m128i nonAscii = _mm_and_si128(_mm_or_si128(low, high), nonAsciiBits);
+            if (_mm_movemask_epi8(_mm_cmpeq_epi16(nonAscii, _mm_setzero_si128())) != 0xFFFF)
+                break;
+
+            // all units are below 0x80, so the saturating pack is a plain narrowing
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(low, high));
+        }
+#elif defined(LOG_READER_NEON)
+        for (; i + k_simdUnits <= count; i += k_simdUnits)
+        {
+            uint16x8_t low = vreinterpretq_u16_u8(vld1q_u8(reinterpret_cast<const uint8_t*>(units + 2 * i)));
+            uint16x8_t high = vreinterpretq_u16_u8(vld1q_u8(reinterpret_cast<const uint8_t*>(units + 2 * i + 16)));
+            if (vmaxvq_u16(vorrq_u16(low, high)) >= 0x80)
+                break;
+
+            vst1q_u8(reinterpret_cast<uint8_t*>(out + i), vcombine_u8(vmovn_u16(low), vmovn_u16(high)));
+        }
+#endif
+        return i;
+    }
+}
+
+LogReader::LogReader(const std::string& fileName)
+    : m_file(fileName, std::ios::binary)
+    , m_raw(k_chunkSize)
+{
+    if (!m_file.is_open())
+        throw Error("Error: could not open file ", fileName);
+
+    detectEncoding();
+}
+
+std::size_t LogReader::readFile(char* buffer, std::size_t size)
+{
+    m_file.read(buffer, static_cast<std::streamsize>(size));
+    std::size_t read = static_cast<std::size_t>(m_file.gcount());
+    m_bytesRead += read;
+    return read;
+}
+
+void LogReader::detectEncoding()
+{
+    std::size_t size = readFile(m_raw.data(), m_raw.size());
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(m_raw.data());
+
+    if (size >= 2 && bytes[0] == 0xFE && bytes[1] == 0xFF)
+        throw Error("Error: UTF-16BE logs are not supported, please save the log as UTF-8 or UTF-16LE");
+
+    std::size_t bomSize = 0;
+    if (size >= 2 && bytes[0] == 0xFF && bytes[1] == 0xFE)
+    {
+        m_encoding = Encoding::Utf16le;
+        bomSize = 2;
+    }
+    else if (size >= 3 && bytes[0] == 0xEF && bytes[1] == 0xBB && bytes[2] == 0xBF)
+    {
+        bomSize = 3;
+    }
+    else if (size >= 2 && bytes[0] != 0 && bytes[1] == 0)
+    {
+        // no BOM, but a text log never has a NUL as its second byte
+        m_encoding = Encoding::Utf16le;
+    }
+
+    if (m_encoding == Encoding::Utf8)
+    {
+        m_text.assign(m_raw.data() + bomSize, size - bomSize);
+        return;
+    }
+
+    m_rawSize = size - bomSize;
+    std::copy(m_raw.begin() + bomSize, m_raw.begin() + size, m_raw.begin());
+    std::size_t consumed = transcodeUtf16le(m_raw.data(), m_rawSize, size < m_raw.size(), m_text);
+    std::copy(m_raw.begin() + consumed, m_raw.begin() + m_rawSize, m_raw.begin());
+    m_rawSize -= consumed;
+}
+
+bool LogReader::fill()
+{
+    // drop the returned lines, an incomplete last line stays
+    m_text.erase(0, m_textPosition);
+    m_textPosition = 0;
+
+    if (m_encoding == Encoding::Utf8)
+    {
+        std::size_t size = m_text.size();
+        m_text.resize(size + k_chunkSize);
+        std::size_t read = readFile(m_text.data() + size, k_chunkSize);
+        m_text.resize(size + read);
+        return read > 0;
+    }
+
+    // a tail of the previous chunk (an odd byte or a high surrogate) is completed by this one
+    std::size_t requested = m_raw.size() - m_rawSize;
+    std::size_t read = readFile(m_raw.data() + m_rawSize, requested);
+    m_rawSize += read;
+
+    std::size_t consumed = transcodeUtf16le(m_raw.data(), m_rawSize, read < requested, m_text);
+    std::copy(m_raw.begin() + consumed, m_raw.begin() + m_rawSize, m_raw.begin());
+    m_rawSize -= consumed;
+    return read > 0 || consumed > 0;
+}
+
+bool LogReader::getLine(std::string& line)
+{
+    for (;;)
+    {
+        const char* begin = m_text.data() + m_textPosition;
+        if (const void* end = std::memchr(begin, '\n', m_text.size() - m_textPosition); end)
+        {
+            std::size_t length = static_cast<const char*>(end) - begin;
+            m_textPosition += length + 1;
+            if (length > 0 && begin[length - 1] == '\r')
+                --length;
+
+            line.assign(begin, length);
+            return true;
+        }
+
+        if (!fill())
+            break;
+    }
+
+    // the last line has no line ending
+    if (m_textPosition == m_text.size())
+        return false;
+
+    line.assign(m_text, m_textPosition);
+    if (!line.empty() && line.back() == '\r')
+        line.pop_back();
+
+    m_textPosition = m_text.size();
+    return true;
+}
+
+std::size_t LogReader::transcodeUtf16le(const char* units, std::size_t size, bool isLast, std::string& text)
+{
+    static constexpr unsigned k_replacement = 0xFFFD;
+
+    const std::size_t count = size / 2;
+    const std::size_t textSize = text.size();
+    text.resize(textSize + count * 3 + 3);     // a code unit takes at most 3 bytes, a surrogate pair 4
+    char* const outBegin = text.data() + textSize;
+    char* out = outBegin;
+
+    std::size_t i = 0;
+    while (i < count)
+    {
+        std::size_t ascii = copyAscii(units + 2 * i, count - i, out);
+        i += ascii;
+        out += ascii;
+
+        // the vector step stopped at a non-ASCII unit, go on one unit at a time until the next vector step
+        for (std::size_t stepEnd = std::min(count, i + k_simdUnits); i < stepEnd; )
+        {
+            unsigned unit = loadUnit(units, i);
+            if (unit < 0xD800 || unit > 0xDFFF)
+            {
+                out = appendUtf8(unit, out);
+                ++i;
+            }
+            else if (unit >= 0xDC00)
+            {
+                out = appendUtf8(k_replacement, out);   // lone low surrogate
+                ++i;
+            }
+            else if (i + 1 == count && !isLast)
+            {
+                // the low surrogate is in the next chunk
+                text.resize(textSize + (out - outBegin));
+                return 2 * i;
+            }
+            else if (unsigned low = i + 1 < count ? loadUnit(units, i + 1) : 0; low >= 0xDC00 && low <= 0xDFFF)
+            {
+                out = appendUtf8(0x10000 + ((unit - 0xD800) << 10) + (low - 0xDC00), out);
+                i += 2;
+            }
+            else
+            {
+                out = appendUtf8(k_replacement, out);   // lone high surrogate
+                ++i;
+            }
+        }
+    }
+
+    text.resize(textSize + (out - outBegin));
+
+    // an odd trailing byte is completed by the next chunk, or dropped at the end of the file
+    return isLast ? size : 2 * count;
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Reads a compilation log line by line as UTF-8.
+// UTF-8 logs (with or without a BOM) are passed through; UTF-16LE logs with a BOM, as saved
+// from the Visual Studio Output window or by msbuild /fl on some agents, are transcoded while reading.
+class LogReader
+{
+public:
+    enum class Encoding
+    {
+        Utf8,
+        Utf16le,
+    };
+
+    explicit LogReader(const std::string& fileName);
+
+    LogReader(const LogReader&) = delete;
+    LogReader& operator=(const LogReader&) = delete;
+
+    // false at the end of the file; the line ending, either "\n" or "\r\n", is not included
+    bool getLine(std::string& line);
+
+    Encoding encoding() const { return m_encoding; }
+    std::uintmax_t bytesRead() const { return m_bytesRead; }   // raw file bytes, for the progress
+
+private:
+    static constexpr std::size_t k_chunkSize = 1 << 16;
+
+    std::ifstream m_file;
+    Encoding m_encoding = Encoding::Utf8;
+    std::uintmax_t m_bytesRead = 0;
+
+    std::vector<char> m_raw;        // UTF-16LE bytes read from the file
+    std::size_t m_rawSize = 0;      // including the tail left from the previous chunk
+    std::string m_text;             // UTF-8 text, not yet returned lines start at m_textPosition
+    std::size_t m_textPosition = 0;
+
+    void detectEncoding();
+    bool fill();                    // appends the next chunk to m_text, false at the end of the file
+    std::size_t readFile(char* buffer, std::size_t size);
+
+    // transcodes complete code units and surrogate pairs, returns the number of bytes consumed
+    static std::size_t transcodeUtf16le(const char* units, std::size_t size, bool isLast, std::string& text);
+};
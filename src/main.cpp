@@ -5,12 +5,23 @@
 
 #include <iostream>
 #include <cassert>
+#include <algorithm>
+#include <future>
+#include <iomanip>
+#include <thread>
 
 #include "argh.h"
 
 #include "model.h"
 #include "error.h"
 #include "msvcParser.h"
+#include "includeAggregator.h"
+#include "modelDiff.h"
+#include "pchAdvisor.h"
+#include "queryServer.h"
+#include "redundantIncludes.h"
+#include "rebuildImpact.h"
+#include "timeTrace.h"
 #include "config.h"
 #include "ui.h"
 
@@ -24,42 +35,375 @@ void printCycle(const Model::Header& header)
         printCycle(child);
 }
 
-int main(int argc, const char* argv[])
+void printCycles(const Model& model)
 {
-    Config config = argh::parser(argv);
-    if (config.m_showUsage)
+    for (const auto& [_, project] : model.projects())
+        for (const auto& [_, unit] : project.modules())
+            for (const auto& header : unit.headers())
+                printCycle(header);
+}
+
+void printIncluders(const Model& model, const std::string& query)
+{
+    std::vector<Model::HeaderId> found = model.findHeaders(query);
+    if (found.empty())
+        std::cout << "Header not found: " << query << std::endl;
+
+    for (Model::HeaderId id : found)
     {
-        config.showUsageMessage();
-        return 1;
+        const std::vector<Model::Includer>& includers = model.includers(id);
+        std::cout << includers.front().m_header->name() << " - included " << includers.size() << " time(s):" << std::endl;
+        for (const Model::Includer& includer : includers)
+        {
+            std::cout << "  " << includer.m_project->name() << " / " << includer.m_module->name()
+                      << ": " << (includer.m_parent ? includer.m_parent->name() : includer.m_module->name()) << std::endl;
+        }
+    }
+}
+
+void printPchRecommendations(const Model& model, const Config& config)
+{
+    PchAdvisor advisor = PchAdvisor(config.m_pchMaxHeaders, config.m_pchMaxIncludes);
+    for (const auto& [_, project] : model.projects())
+    {
+        PchAdvisor::Recommendation recommendation = advisor.recommend(project);
+        double savedPercent = recommendation.m_totalIncludes ? 100.0 * recommendation.m_savedIncludes / recommendation.m_totalIncludes : 0.0;
+
+        std::cout << "// pch.h candidate for project " << project.name() << ": " << recommendation.m_headers.size() << " header(s), "
+                  << recommendation.m_pchIncludes << " include(s) precompiled" << std::endl
+                  << "// estimated savings: " << recommendation.m_savedIncludes << " of " << recommendation.m_totalIncludes
+                  << " include events (" << static_cast<int>(savedPercent) << "%)" << std::endl;
+
+        for (const PchAdvisor::Candidate& candidate : recommendation.m_headers)
+        {
+            std::cout << "#include \"" << candidate.m_header->name() << "\"    // " << candidate.m_moduleCount << " modules, saves "
+                      << candidate.m_savedIncludes << " includes" << std::endl;
+        }
+
+        std::cout << std::endl;
+    }
+}
+
+void printRedundantIncludes(Model& model)
+{
+    model.updateReachable();
+    RedundantIncludes redundant = RedundantIncludes(model);
+    for (const RedundantIncludes::Finding& finding : redundant.findings())
+    {
+        const std::string& includer = finding.m_parent ? finding.m_parent->name() : finding.m_module->name();
+        std::cout << finding.m_project->name() << " / " << finding.m_module->name() << ": " << includer
+                  << " includes " << finding.m_header->name() << " again, already included via " << finding.m_via->name() << std::endl;
+    }
+
+    std::cout << redundant.findings().size() << " redundant include(s)" << std::endl;
+}
+
+void printRebuildImpact(const Model& model, std::size_t top)
+{
+    RebuildImpact impact = RebuildImpact(model);
+    const std::vector<RebuildImpact::Impact>& ranking = impact.ranking();
+
+    std::cout << "Headers by modules to rebuild when changed, of " << impact.moduleCount() << " module(s):" << std::endl;
+    for (std::size_t i = 0; i < std::min(ranking.size(), top); ++i)
+    {
+        std::cout << std::setw(8) << ranking[i].m_moduleCount << "  " << ranking[i].m_header->name() << std::endl;
+        for (const RebuildImpact::ProjectImpact& project : impact.byProject(ranking[i]))
+            std::cout << std::setw(16) << project.m_moduleCount << "  " << project.m_project->name() << std::endl;
+    }
+}
+
+void printTimeRanking(const Model& model, std::size_t top)
+{
+    struct HeaderTime
+    {
+        Model::HeaderId m_id = 0;
+        double m_inclusiveMs = 0;
+        double m_exclusiveMs = 0;
+        std::size_t m_occurrences = 0;
+    };
+
+    std::vector<HeaderTime> ranking;
+    for (Model::HeaderId id = 0; id < model.headerCount(); ++id)
+    {
+        HeaderTime time{ id };
+        for (const Model::Includer& includer : model.includers(id))
+        {
+            // own time of a nested occurrence is real, its inclusive time is in the outer occurrence already
+            time.m_exclusiveMs += includer.m_header->exclusiveMs();
+            if (includer.m_header->isCycle())
+                continue;
+
+            time.m_inclusiveMs += includer.m_header->inclusiveMs();
+            ++time.m_occurrences;
+        }
+
+        if (time.m_inclusiveMs > 0)
+            ranking.push_back(time);
     }
-    
-    std::string compilationLogFile = argv[1];
 
+    std::sort(ranking.begin(), ranking.end(), [](const HeaderTime& left, const HeaderTime& right) { return left.m_inclusiveMs > right.m_inclusiveMs; });
+    ranking.resize(std::min(ranking.size(), top));
+
+    std::cout << "Headers by total frontend time (inclusive / exclusive ms, occurrences):" << std::endl;
+    for (const HeaderTime& time : ranking)
+    {
+        std::cout << std::fixed << std::setprecision(1) << std::setw(12) << time.m_inclusiveMs << std::setw(12) << time.m_exclusiveMs
+                  << std::setw(8) << time.m_occurrences << "  " << model.includers(time.m_id).front().m_header->name() << std::endl;
+    }
+}
+
+void printChain(const IncludeAggregator& aggregator, const IncludeAggregator::Chain& chain)
+{
+    std::cout << chain.m_project << " / " << chain.m_module << ": ";
+    for (std::size_t i = 0; i < chain.m_headers.size(); ++i)
+        std::cout << (i ? " -> " : "") << aggregator.headers()[chain.m_headers[i]].m_name;
+    std::cout << std::endl;
+}
+
+void printAggregates(const IncludeAggregator& aggregator, std::size_t top)
+{
+    using HeaderStats = IncludeAggregator::HeaderStats;
+    const std::vector<HeaderStats>& headers = aggregator.headers();
+
+    std::cout << aggregator.projectCount() << " project(s), " << aggregator.moduleCount() << " module(s), "
+              << aggregator.includeCount() << " include(s) of " << headers.size() << " distinct header(s)" << std::endl;
+
+    // heaviest: include events caused by the header, its own and beneath it
+    std::vector<const HeaderStats*> ranking;
+    ranking.reserve(headers.size());
+    for (const HeaderStats& stats : headers)
+        ranking.push_back(&stats);
+
+    auto weight = [](const HeaderStats* stats) { return stats->m_includeCount + stats->m_beneathTotal; };
+    auto rankingEnd = ranking.begin() + std::min(ranking.size(), top);
+    std::partial_sort(ranking.begin(), rankingEnd, ranking.end(), [&weight](const HeaderStats* left, const HeaderStats* right) { return weight(left) > weight(right); });
+
+    std::cout << "Heaviest headers (includes, modules, includes beneath: total / largest):" << std::endl;
+    for (auto it = ranking.begin(); it != rankingEnd; ++it)
+    {
+        const HeaderStats& stats = **it;
+        std::cout << std::setw(12) << stats.m_includeCount << std::setw(8) << stats.m_moduleCount
+                  << std::setw(14) << stats.m_beneathTotal << std::setw(8) << stats.m_beneathMax << "  " << stats.m_name << std::endl;
+    }
+
+    std::cout << aggregator.cycles().size() << " header(s) in include cycles:" << std::endl;
+    for (const IncludeAggregator::Chain& cycle : aggregator.cycles())
+    {
+        std::cout << std::setw(8) << headers[cycle.m_headers.front()].m_cycleCount << "  ";
+        printChain(aggregator, cycle);
+    }
+
+    std::cout << "Deepest include chains:" << std::endl;
+    for (const IncludeAggregator::Chain& chain : aggregator.deepestChains())
+    {
+        std::cout << std::setw(8) << chain.m_headers.size() << "  ";
+        printChain(aggregator, chain);
+    }
+}
+
+void printDiff(const ModelDiff& diff)
+{
+    for (const ModelDiff::ModuleDiff& unit : diff.modules())
+    {
+        std::cout << unit.m_project << " / " << unit.m_module
+                  << ": includes " << (unit.m_includeCountDelta > 0 ? "+" : "") << unit.m_includeCountDelta << std::endl;
+
+        for (const ModelDiff::Edge& edge : unit.m_added)
+            std::cout << "  + " << (edge.m_parent.empty() ? unit.m_module : edge.m_parent) << " -> " << edge.m_child << std::endl;
+        for (const ModelDiff::Edge& edge : unit.m_removed)
+            std::cout << "  - " << (edge.m_parent.empty() ? unit.m_module : edge.m_parent) << " -> " << edge.m_child << std::endl;
+    }
+}
+
+Model loadModel(const Config& config, const std::string& fileName)
+{
     Model model = Model(config);
-    MsvcParser msvcParser = MsvcParser(config);
+    MsvcParser(config).parse(model, fileName);
+    model.updateSubtreeHashes();
+    return model;
+}
 
+int runDiff(const Config& config)
+{
     try
     {
-        msvcParser.parse(model);
-        model.purgeEmpties();
-        if (config.m_simplifyPath)
-            model.simplifyPath();
+        // logs are independent, parse them side by side
+        std::future<Model> oldModel = std::async(std::launch::async, loadModel, std::cref(config), config.m_inputFile);
+        Model newModel = loadModel(config, config.m_diffInputFile);
 
-        for (const auto& [_, project] : model.projects())
-            for (const auto& [_, unit] : project.modules())
-                for (const auto& header : unit.headers())
-                    printCycle(header);
+        ModelDiff diff = ModelDiff(oldModel.get(), newModel);
+        printDiff(diff);
+
+        auto screen = ftxui::ScreenInteractive::FitComponent();
+        screen.TrackMouse(false);
+
+        UI ui = UI(config);
+        screen.Loop(ui.make(diff));
     }
-    catch(const std::exception& e)
+    catch (const std::exception& e)
     {
         std::cerr << e.what() << '\n';
         return 1;
     }
 
-    UI ui = UI(config);
-    auto mine = ui.make(model);
+    return 0;
+}
+
+int runServer(const Config& config)
+{
+    try
+    {
+        QueryServer server(config, [&config] { return loadModel(config, config.m_inputFile); });
+        server.run();
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+
+    return 0;
+}
+
+int runAggregate(const Config& config)
+{
+    try
+    {
+        IncludeAggregator aggregator(config.m_top);
+        MsvcParser(config).parse(config.m_inputFile, aggregator);
+        printAggregates(aggregator, config.m_top);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+
+    return 0;
+}
+
+int runHeadless(const Config& config)
+{
+    try
+    {
+        Model model = Model(config);
+        MsvcParser(config).parse(model);
+        printCycles(model);
+
+        if (!config.m_timeTrace.empty())
+        {
+            TimeTrace traces = TimeTrace(config.m_timeTrace);
+            for (auto& [_, project] : model.projects())
+                traces.attach(project);
+
+            for (const std::string& warning : traces.warnings())
+                std::cerr << warning << std::endl;
+
+            printTimeRanking(model, config.m_top);
+        }
+
+        if (!config.m_includersOf.empty())
+            printIncluders(model, config.m_includersOf);
+        if (config.m_pch)
+            printPchRecommendations(model, config);
+        if (config.m_redundant)
+            printRedundantIncludes(model);
+        if (config.m_impact)
+            printRebuildImpact(model, config.m_top);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+
+    return 0;
+}
+
+int runInteractive(const Config& config)
+{
+    Model model = Model(config);
+
+    // the screen outlives the UI: UI's search worker posts to it until joined
     auto screen = ftxui::ScreenInteractive::FitComponent();
     screen.TrackMouse(false);
+
+    UI ui = UI(config);
+    auto mine = ui.make(model, screen);
+
+    // parse in background; the model is only modified on the UI thread as projects get complete
+    std::optional<TimeTrace> traces;    // used by the parser thread only, until joined
+    std::jthread parser([&](std::stop_token stopToken)
+        {
+            auto onProjectParsed = [&](MsvcParser::ProjectId projectId, Model::Project&& project)
+                {
+                    if (traces)
+                        traces->attach(project);
+
+                    auto parsed = std::make_shared<Model::Project>(std::move(project));
+                    screen.Post([&, projectId, parsed]
+                        {
+                            try
+                            {
+                                ui.addProject(model.addProject(projectId, std::move(*parsed)));
+                            }
+                            catch (const std::exception& e)
+                            {
+                                ui.finishLoading(e.what());
+                            }
+                        });
+                };
+
+            auto onProgress = [&](std::uintmax_t bytesParsed, std::uintmax_t totalBytes)
+                {
+                    screen.Post([&ui, bytesParsed, totalBytes] { ui.setProgress(bytesParsed, totalBytes); });
+                };
+
+            try
+            {
+                if (!config.m_timeTrace.empty())
+                    traces.emplace(config.m_timeTrace);
+
+                MsvcParser(config).parse(config.m_inputFile, onProjectParsed, onProgress, stopToken);
+                screen.Post([&ui] { ui.finishLoading(std::string()); });
+            }
+            catch (const std::exception& e)
+            {
+                screen.Post([&ui, error = std::string(e.what())] { ui.finishLoading(error); });
+            }
+        });
+
     screen.Loop(mine);
 
-}
\ No newline at end of file
+    parser.request_stop();
+    parser.join();
+    printCycles(model);
+    if (traces)
+        for (const std::string& warning : traces->warnings())
+            std::cerr << warning << std::endl;
+    return 0;
+}
+
+int main(int argc, const char* argv[])
+{
+    Config config = argh::parser(argv);
+    if (config.m_showUsage)
+    {
+        config.showUsageMessage();
+        return 1;
+    }
+
+    if (config.m_diff)
+        return runDiff(config);
+
+    if (!config.m_serveSocket.empty())
+        return runServer(config);
+
+    if (config.m_aggregate)
+        return runAggregate(config);
+
+    if (config.isHeadless())
+        return runHeadless(config);
+
+    return runInteractive(config);
+}
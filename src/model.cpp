@@ -5,9 +5,82 @@
 #include <cassert>
 #include <locale>
 #include <array>
+#include <bit>
+#include <functional>
 
 #include <filesystem>
 
+std::vector<SparseBitset::Block>::const_iterator SparseBitset::findBlock(std::uint32_t index) const
+{
+    return std::lower_bound(m_blocks.begin(), m_blocks.end(), index, [](const Block& block, std::uint32_t index) { return block.first < index; });
+}
+
+bool SparseBitset::test(std::uint32_t value) const
+{
+    auto it = findBlock(value / 64);
+    return it != m_blocks.end() && it->first == value / 64 && (it->second >> (value % 64) & 1);
+}
+
+void SparseBitset::set(std::uint32_t value)
+{
+    auto it = m_blocks.begin() + (findBlock(value / 64) - m_blocks.cbegin());
+    if (it == m_blocks.end() || it->first != value / 64)
+        it = m_blocks.emplace(it, value / 64, 0);
+
+    it->second |= std::uint64_t(1) << (value % 64);
+}
+
+void SparseBitset::unite(const SparseBitset& other)
+{
+    if (other.m_blocks.empty())
+        return;
+
+    std::vector<Block> merged;
+    merged.reserve(m_blocks.size() + other.m_blocks.size());
+
+    auto left = m_blocks.begin();
+    auto right = other.m_blocks.begin();
+    while (left != m_blocks.end() || right != other.m_blocks.end())
+    {
+        if (right == other.m_blocks.end() || (left != m_blocks.end() && left->first < right->first))
+            merged.push_back(*left++);
+        else if (left == m_blocks.end() || right->first < left->first)
+            merged.push_back(*right++);
+        else
+        {
+            merged.emplace_back(left->first, left->second | right->second);
+            ++left;
+            ++right;
+        }
+    }
+
+    m_blocks = std::move(merged);
+}
+
+std::size_t SparseBitset::count() const
+{
+    std::size_t count = 0;
+    for (const Block& block : m_blocks)
+        count += std::popcount(block.second);
+    return count;
+}
+
+std::size_t SparseBitset::count(std::uint32_t begin, std::uint32_t end) const
+{
+    std::size_t count = 0;
+    for (auto it = findBlock(begin / 64); it != m_blocks.end() && std::uint64_t(it->first) * 64 < end; ++it)
+    {
+        std::uint64_t bits = it->second;
+        if (it->first == begin / 64)
+            bits &= ~std::uint64_t(0) << (begin % 64);
+        if (it->first == end / 64)
+            bits &= (std::uint64_t(1) << (end % 64)) - 1;
+
+        count += std::popcount(bits);
+    }
+    return count;
+}
+
 char Model::normalizePathChar(char c)
 {
 #if WIN32
@@ -16,7 +89,8 @@ char Model::normalizePathChar(char c)
             std::array<char, 256> mapping;
             for (int i = 0; i < 256; ++i)
             {
-                char c = std::tolower(static_cast<char>(i));
+                // ASCII only, bytes of multibyte UTF-8 sequences are kept as is
+                char c = static_cast<char>(i >= 'A' && i <= 'Z' ? i - 'A' + 'a' : i);
                 if (c == '/')
                     c = '\\';
                 mapping[i] = c;
@@ -53,6 +127,18 @@ void Model::Project::simplifyPath()
         unit.simplifyPath();
 }
 
+void Model::Project::updateSubtreeHashes()
+{
+    for (auto& [_, unit] : m_modules)
+        unit.updateSubtreeHash();
+}
+
+void Model::Project::updateReachable()
+{
+    for (auto& [_, unit] : m_modules)
+        unit.updateReachable();
+}
+
 bool Model::Project::isEmpty() const
 {
     return m_modules.empty()
@@ -68,6 +154,16 @@ Model::Project& Model::addProject(ProjectId projectId, std::string projectName)
     return it->second;
 }
 
+Model::Project& Model::addProject(ProjectId projectId, Project&& project)
+{
+    auto [it, isInserted] = m_projects.emplace(projectId, std::move(project));
+    if (!isInserted)
+        throw Error("Error: project id ", std::to_string(projectId), " already exists");
+
+    indexIncluders(it->second);
+    return it->second;
+}
+
 Model::Project& Model::getProject(ProjectId projectId)
 {
     auto it = m_projects.find(projectId);
@@ -77,27 +173,90 @@ Model::Project& Model::getProject(ProjectId projectId)
     return it->second;
 }
 
-void Model::purgeEmpties()
+void Model::simplifyPath()
+{
+    for (auto& [_, project] : m_projects)
+        project.simplifyPath();
+}
+
+void Model::updateSubtreeHashes()
+{
+    for (auto& [_, project] : m_projects)
+        project.updateSubtreeHashes();
+}
+
+void Model::updateReachable()
+{
+    for (auto& [_, project] : m_projects)
+        project.updateReachable();
+}
+
+void Model::indexIncluders(Project& project)
+{
+    for (auto& [_, unit] : project.modules())
+        for (Header& header : unit.headers())
+            indexIncluders(project, unit, nullptr, header);
+}
+
+void Model::indexIncluders(const Project& project, const Module& unit, const Header* parent, Header& header)
 {
-    for (auto itProject = m_projects.begin(); itProject != m_projects.end();)
+    HeaderId id = internHeader(header.normalizedName());
+    header.setId(id);
+    m_includers[id].push_back(Includer{ &project, &unit, parent, &header });
+
+    for (Header& child : header.children())
+        indexIncluders(project, unit, &header, child);
+}
+
+Model::HeaderId Model::internHeader(const std::string& normalizedName)
+{
+    auto [it, isInserted] = m_headerIds.emplace(normalizedName, static_cast<HeaderId>(m_includers.size()));
+    if (isInserted)
     {
-        if (itProject->second.isEmpty())
-            itProject = m_projects.erase(itProject);
-        else
-            ++itProject;
+        m_includers.emplace_back();
+        m_headerIdsByFile.emplace(fileName(normalizedName), it->second);
     }
+
+    return it->second;
 }
 
-void Model::simplifyPath()
+std::vector<Model::HeaderId> Model::findHeaders(std::string_view query) const
 {
-    for (auto& [_, project] : m_projects)
-        project.simplifyPath();
+    // either the full path, or just a file name that may be shared by several headers
+    std::string normalizedQuery(query);
+    std::transform(normalizedQuery.begin(), normalizedQuery.end(), normalizedQuery.begin(), &Model::normalizePathChar);
+
+    if (auto it = m_headerIds.find(normalizedQuery); it != m_headerIds.end())
+        return { it->second };
+
+    std::vector<HeaderId> found;
+    auto [begin, end] = m_headerIdsByFile.equal_range(std::string(fileName(normalizedQuery)));
+    for (auto it = begin; it != end; ++it)
+        found.push_back(it->second);
+
+    std::sort(found.begin(), found.end());
+    return found;
+}
+
+std::string_view Model::fileName(std::string_view normalizedPath)
+{
+    std::string_view::size_type separator = normalizedPath.find_last_of("\\/");
+    return separator == std::string_view::npos ? normalizedPath : normalizedPath.substr(separator + 1);
+}
+
+Model::Hash Model::combineHash(Hash seed, Hash value)
+{
+    // boost::hash_combine, widened to 64 bit
+    return seed ^ (value + 0x9e3779b97f4a7c15ull + (seed << 12) + (seed >> 4));
 }
 
 std::string Model::normalizePath(std::string_view path)
 {
-    std::string normalized = std::filesystem::weakly_canonical(path).string();
-    std::transform(normalized.begin(), normalized.end(), std::back_inserter(normalized), &Model::normalizePathChar);
+    // names are UTF-8, a narrow path would use the ANSI code page on Windows
+    std::u8string_view utf8Path(reinterpret_cast<const char8_t*>(path.data()), path.size());
+    std::u8string canonical = std::filesystem::weakly_canonical(utf8Path).u8string();
+    std::string normalized(canonical.begin(), canonical.end());
+    std::transform(normalized.begin(), normalized.end(), normalized.begin(), &Model::normalizePathChar);
     return normalized;
 }
 
@@ -171,6 +330,32 @@ void Model::Module::simplifyPath()
         header.simplifyPath(prefixSize);
 }
 
+void Model::Module::updateSubtreeHash()
+{
+    m_subtreeHash = 0;
+    m_includeCount = 0;
+    for (Header& header : m_headers)
+    {
+        header.updateSubtreeHash();
+        m_subtreeHash = combineHash(m_subtreeHash, header.subtreeHash());
+        m_includeCount += header.subtreeSize();
+    }
+}
+
+double Model::Module::inclusiveMs() const
+{
+    double inclusiveMs = 0;
+    for (const Header& header : m_headers)
+        inclusiveMs += header.inclusiveMs();
+    return inclusiveMs;
+}
+
+void Model::Module::updateReachable()
+{
+    for (Header& header : m_headers)
+        header.updateReachable();
+}
+
 Model::Header::Header(const std::string& name, const std::string& normalizedName, bool isCycle)
     : m_name(name)
     , m_normalizedName(normalizedName)
@@ -201,6 +386,13 @@ bool Model::Header::tryMatch(const std::string& normalizedString)
     return hasMatch;
 }
 
+void Model::Header::clearMatch()
+{
+    m_match = {};
+    m_traits.reset(HeaderTraits::IsMatched);
+    m_traits.reset(HeaderTraits::HasMatch);
+}
+
 Model::Header* Model::Header::getLastChild()
 {
     return m_children.empty() ? nullptr : std::addressof(m_children.back());
@@ -212,3 +404,27 @@ void Model::Header::simplifyPath(size_t prefixSize)
     for (Header& child : m_children)
         child.simplifyPath(prefixSize);
 }
+
+void Model::Header::updateSubtreeHash()
+{
+    // children are ordered, so the same set of includes in a different order yields a different hash
+    m_subtreeHash = std::hash<std::string>()(m_normalizedName);
+    m_subtreeSize = 1;
+    for (Header& child : m_children)
+    {
+        child.updateSubtreeHash();
+        m_subtreeHash = combineHash(m_subtreeHash, child.subtreeHash());
+        m_subtreeSize += child.subtreeSize();
+    }
+}
+
+void Model::Header::updateReachable()
+{
+    m_reachable = SparseBitset();
+    for (Header& child : m_children)
+    {
+        child.updateReachable();
+        m_reachable.set(child.id());
+        m_reachable.unite(child.reachable());
+    }
+}
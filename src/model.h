@@ -3,12 +3,33 @@
 #include <vector>
 #include <map>
 #include <optional>
+#include <string_view>
+#include <unordered_map>
 
 #include <bitset>
+#include <cstdint>
 #include <type_traits>
 
 struct Config;
 
+// compact set of small integers: sorted 64-bit blocks, only non-empty ones are stored
+class SparseBitset
+{
+    using Block = std::pair<std::uint32_t, std::uint64_t>;    // (value / 64, bits)
+    std::vector<Block> m_blocks;
+
+    std::vector<Block>::const_iterator findBlock(std::uint32_t index) const;
+
+public:
+    bool test(std::uint32_t value) const;
+    void set(std::uint32_t value);
+    void unite(const SparseBitset& other);
+
+    bool empty() const { return m_blocks.empty(); }
+    std::size_t count() const;
+    std::size_t count(std::uint32_t begin, std::uint32_t end) const;   // values in [begin, end)
+};
+
 template<typename T>
 class EnumBits
 {
@@ -29,12 +50,15 @@ public:
 
     bool test(T pos) const  { return m_bits.test(get_value(pos)); }
     void set(T pos)         { m_bits.set(get_value(pos)); }
+    void reset(T pos)       { m_bits.reset(get_value(pos)); }
 };
 
 class Model
 {
 public:
     using ProjectId = int;
+    using Hash = std::uint64_t;
+    using HeaderId = std::uint32_t;    // interned normalized header name
 
     enum class HeaderTraits
     {
@@ -65,9 +89,12 @@ public:
 
         const std::string& name() const { return m_name; }
         const std::string& normalizedName() const { return m_normalizedName; }
+        HeaderId id() const { return m_id; }
+        void setId(HeaderId id) { m_id = id; }
 
         Header& emplaceChild(const std::string& name, const std::string& normalizedName, bool isCycleDependency);
         const std::vector<Header>& children() const { return m_children; }
+        std::vector<Header>& children() { return m_children; }
         
         bool isLeaf() const   { return m_children.empty(); }
         bool hasCycle() const { return m_traits.test(HeaderTraits::HasCycle); }
@@ -79,11 +106,26 @@ public:
         void setHasMatch() { m_traits.set(HeaderTraits::HasMatch); }
         void setIsCycle()  { m_traits.set(HeaderTraits::IsCycle); }
         bool tryMatch(const std::string& normalizedString);
+        void clearMatch();
 
         Header* getLastChild();
         MatchInfo getMatch() const { return m_match; }
         void simplifyPath(size_t prefixSize);
 
+        // Merkle hash of the normalized names in this subtree, valid after updateSubtreeHash()
+        Hash subtreeHash() const { return m_subtreeHash; }
+        std::size_t subtreeSize() const { return m_subtreeSize; }   // this header + all nested includes
+        void updateSubtreeHash();
+
+        // frontend time from clang -ftime-trace, summed over all traces matched to this node
+        double inclusiveMs() const { return m_inclusiveMs; }
+        double exclusiveMs() const { return m_exclusiveMs; }
+        void addTime(double inclusiveMs, double exclusiveMs) { m_inclusiveMs += inclusiveMs; m_exclusiveMs += exclusiveMs; }
+
+        // ids of all headers nested in this one, valid after updateReachable()
+        const SparseBitset& reachable() const { return m_reachable; }
+        void updateReachable();
+
     private:
         std::string m_name;
         std::string m_normalizedName;
@@ -91,6 +133,12 @@ public:
         std::vector<Header> m_children;
         EnumBits<HeaderTraits> m_traits;
         MatchInfo m_match;
+        HeaderId m_id = 0;
+        Hash m_subtreeHash = 0;
+        std::size_t m_subtreeSize = 1;
+        SparseBitset m_reachable;
+        double m_inclusiveMs = 0;
+        double m_exclusiveMs = 0;
     };
 
     class Module 
@@ -100,6 +148,8 @@ public:
         const Config& m_config; 
         bool m_hasCycle = false;
         std::string m_longestPrefix;
+        Hash m_subtreeHash = 0;
+        std::size_t m_includeCount = 0;
 
     public:
         explicit Module(const std::string& name, const Config& config) : m_name(name), m_config(config) {};
@@ -113,10 +163,17 @@ public:
 
         const std::string& name() const { return m_name; }
         const std::vector<Header>& headers() const { return m_headers; }
+        std::vector<Header>& headers() { return m_headers; }
+
+        Hash subtreeHash() const { return m_subtreeHash; }
+        std::size_t includeCount() const { return m_includeCount; }
+        double inclusiveMs() const;     // sum over the directly included headers
 
         void insertHeader(int level, const std::string& headerName);
         void updateLongestPrefix(const std::string& normalizedName);
         void simplifyPath();
+        void updateSubtreeHash();
+        void updateReachable();
     };
 
     class Project
@@ -135,32 +192,60 @@ public:
         Module& addModule(const std::string& moduleName);
         Module& getModule(const std::string& moduleName);
         void simplifyPath();
+        void updateSubtreeHashes();
+        void updateReachable();
 
         const std::string& name() const { return m_name; }
 
         bool isEmpty() const;
 
         const std::map<std::string, Module>& modules() const { return m_modules; }
+        std::map<std::string, Module>& modules() { return m_modules; }
+    };
+
+    // single occurrence of a header in the solution
+    struct Includer
+    {
+        const Project* m_project = nullptr;
+        const Module* m_module = nullptr;
+        const Header* m_parent = nullptr;   // nullptr if included directly by the module
+        const Header* m_header = nullptr;
     };
 
     explicit Model(const Config& config) : m_config(config) {}
 
     Project& addProject(ProjectId projectId, std::string projectName);
+    Project& addProject(ProjectId projectId, Project&& project);    // adds a completely parsed project and indexes it
     Project& getProject(ProjectId projectId);
 
-    void purgeEmpties();
     void simplifyPath();
+    void updateSubtreeHashes();
+    void updateReachable();     // needs header ids, i.e. indexed projects
+    void indexIncluders(Project& project);
 
+    std::vector<HeaderId> findHeaders(std::string_view query) const;
+    const std::vector<Includer>& includers(HeaderId id) const { return m_includers[id]; }
+    std::size_t headerCount() const { return m_includers.size(); }
 
     static std::string normalizePath(std::string_view path);
     static char normalizePathChar(char c);
+    static Hash combineHash(Hash seed, Hash value);
 
     const std::map<ProjectId, Project>& projects() const { return m_projects; }
+    std::map<ProjectId, Project>& projects() { return m_projects; }
 
 private:
 
     std::map<ProjectId, Project> m_projects;
     const Config& m_config;
+
+    std::unordered_map<std::string, HeaderId> m_headerIds;             // normalized name -> id
+    std::unordered_multimap<std::string, HeaderId> m_headerIdsByFile;  // normalized file name -> id
+    std::vector<std::vector<Includer>> m_includers;                    // id -> all occurrences
+
+    HeaderId internHeader(const std::string& normalizedName);
+    void indexIncluders(const Project& project, const Module& unit, const Header* parent, Header& header);
+    static std::string_view fileName(std::string_view normalizedPath);
 };
 
 
@@ -0,0 +1,110 @@
+#include "modelDiff.h"
+#include <deque>
+#include <map>
+#include <string_view>
+#include <unordered_map>
+
+ModelDiff::ModelDiff(const Model& oldModel, const Model& newModel)
+{
+    // project ids depend on the build order, so projects are matched by name
+    std::map<std::string, std::pair<const Model::Project*, const Model::Project*>> projects;
+    for (const auto& [_, project] : oldModel.projects())
+        projects[project.name()].first = &project;
+    for (const auto& [_, project] : newModel.projects())
+        projects[project.name()].second = &project;
+
+    for (const auto& [name, oldNewPair] : projects)
+        diffProject(name, oldNewPair.first, oldNewPair.second);
+}
+
+void ModelDiff::diffProject(const std::string& projectName, const Model::Project* oldProject, const Model::Project* newProject)
+{
+    std::map<std::string, std::pair<const Model::Module*, const Model::Module*>> modules;
+    if (oldProject)
+        for (const auto& [name, unit] : oldProject->modules())
+            modules[name].first = &unit;
+    if (newProject)
+        for (const auto& [name, unit] : newProject->modules())
+            modules[name].second = &unit;
+
+    for (const auto& [name, oldNewPair] : modules)
+    {
+        const auto [oldModule, newModule] = oldNewPair;
+        if (oldModule && newModule && oldModule->subtreeHash() == newModule->subtreeHash())
+            continue;
+
+        ModuleDiff diff;
+        diff.m_project = projectName;
+        diff.m_module = name;
+
+        if (oldModule && newModule)
+        {
+            // the hash depends on the include order, a module with its includes only reordered is the same
+            diffModule(diff, *oldModule, *newModule);
+            if (diff.m_added.empty() && diff.m_removed.empty() && diff.m_includeCountDelta == 0)
+                continue;
+        }
+        else if (newModule)
+        {
+            diff.m_status = Status::Added;
+            diff.m_includeCountDelta = static_cast<long long>(newModule->includeCount());
+            for (const Model::Header& header : newModule->headers())
+                diff.m_added.push_back(makeEdge(nullptr, header));
+        }
+        else
+        {
+            diff.m_status = Status::Removed;
+            diff.m_includeCountDelta = -static_cast<long long>(oldModule->includeCount());
+            for (const Model::Header& header : oldModule->headers())
+                diff.m_removed.push_back(makeEdge(nullptr, header));
+        }
+
+        m_modules.push_back(std::move(diff));
+    }
+}
+
+void ModelDiff::diffModule(ModuleDiff& diff, const Model::Module& oldModule, const Model::Module& newModule)
+{
+    diff.m_includeCountDelta = static_cast<long long>(newModule.includeCount()) - static_cast<long long>(oldModule.includeCount());
+    diffChildren(diff, nullptr, oldModule.headers(), newModule.headers());
+}
+
+void ModelDiff::diffChildren(ModuleDiff& diff, const Model::Header* parent, const std::vector<Model::Header>& oldHeaders,
+                             const std::vector<Model::Header>& newHeaders)
+{
+    // pair the n-th occurrence of a header in the old list with its n-th occurrence in the new one
+    std::unordered_map<std::string_view, std::deque<const Model::Header*>> unmatchedOld;
+    for (const Model::Header& header : oldHeaders)
+        unmatchedOld[header.normalizedName()].push_back(&header);
+
+    for (const Model::Header& newHeader : newHeaders)
+    {
+        auto it = unmatchedOld.find(newHeader.normalizedName());
+        if (it == unmatchedOld.end() || it->second.empty())
+        {
+            diff.m_added.push_back(makeEdge(parent, newHeader));
+            continue;
+        }
+
+        const Model::Header* oldHeader = it->second.front();
+        it->second.pop_front();
+        if (oldHeader->subtreeHash() != newHeader.subtreeHash())
+            diffChildren(diff, &newHeader, oldHeader->children(), newHeader.children());
+    }
+
+    // leftovers are gone in the new log; walk the old list again to report them in include order
+    for (const Model::Header& oldHeader : oldHeaders)
+    {
+        auto& candidates = unmatchedOld[oldHeader.normalizedName()];
+        if (!candidates.empty() && candidates.front() == &oldHeader)
+        {
+            diff.m_removed.push_back(makeEdge(parent, oldHeader));
+            candidates.pop_front();
+        }
+    }
+}
+
+ModelDiff::Edge ModelDiff::makeEdge(const Model::Header* parent, const Model::Header& child)
+{
+    return Edge{ parent ? parent->name() : std::string(), child.name(), child.subtreeSize() };
+}
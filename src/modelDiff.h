@@ -0,0 +1,50 @@
+#pragma once
+#include <string>
+#include <vector>
+
+#include "model.h"
+
+// Structural difference between two models of the same solution, e.g. yesterday's and today's build logs.
+// Both models must have their subtree hashes updated; equal hashes are skipped without descending.
+class ModelDiff
+{
+public:
+    enum class Status
+    {
+        Changed,    // module exists in both logs
+        Added,      // module exists in the new log only
+        Removed,    // module exists in the old log only
+    };
+
+    struct Edge
+    {
+        std::string m_parent;           // empty when the header is included by the module itself
+        std::string m_child;
+        std::size_t m_subtreeSize = 1;  // number of includes brought in by this edge
+    };
+
+    struct ModuleDiff
+    {
+        std::string m_project;
+        std::string m_module;
+        Status m_status = Status::Changed;
+        std::vector<Edge> m_added;
+        std::vector<Edge> m_removed;
+        long long m_includeCountDelta = 0;
+    };
+
+    ModelDiff(const Model& oldModel, const Model& newModel);
+
+    const std::vector<ModuleDiff>& modules() const { return m_modules; }
+    bool isEmpty() const { return m_modules.empty(); }
+
+private:
+    std::vector<ModuleDiff> m_modules;
+
+    void diffProject(const std::string& projectName, const Model::Project* oldProject, const Model::Project* newProject);
+    void diffModule(ModuleDiff& diff, const Model::Module& oldModule, const Model::Module& newModule);
+
+    static void diffChildren(ModuleDiff& diff, const Model::Header* parent, const std::vector<Model::Header>& oldHeaders,
+                             const std::vector<Model::Header>& newHeaders);
+    static Edge makeEdge(const Model::Header* parent, const Model::Header& child);
+};
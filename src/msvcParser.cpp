@@ -1,7 +1,9 @@
 #include "msvcParser.h"
 #include "error.h"
+#include "logReader.h"
 #include <regex>
-#include <fstream>
+#include <map>
+#include <filesystem>
 #include <cassert>
 
 #include "model.h"
@@ -72,15 +74,110 @@ MsvcParser::HeaderInfo MsvcParser::extractHeaderInfo(const std::string& headerNa
     };
 }
 
+bool MsvcParser::isProjectDone(const std::string& projectLine)
+{
+    // Examples:
+    // - "test.vcxproj -> C:\path\x64\Debug\test.exe"
+    // - "Done building project "test.vcxproj"."
+    static const std::regex projectDoneRegex(R"(\.vcxproj -> |Done building project)");
+    return std::regex_search(projectLine, projectDoneRegex);
+}
+
+// builds the include trees and publishes every project when its build output is complete
+class MsvcParser::ProjectBuilder : public MsvcParser::Listener
+{
+    const Config& m_config;
+    const ProjectCallback& m_onProjectParsed;
+    std::map<ProjectId, std::string> m_mostRecentModule;
+    std::map<ProjectId, Model::Project> m_projects;     // projects being parsed
+
+public:
+    ProjectBuilder(const Config& config, const ProjectCallback& onProjectParsed)
+        : m_config(config)
+        , m_onProjectParsed(onProjectParsed)
+    {
+    }
+
+    void projectStarted(ProjectId projectId, const std::string& projectName) override
+    {
+        m_projects.emplace(projectId, Model::Project(projectName, m_config));
+    }
+
+    void moduleStarted(ProjectId projectId, const std::string& moduleName) override
+    {
+        getProject(projectId).addModule(moduleName);
+        m_mostRecentModule[projectId] = moduleName;
+    }
+
+    void headerIncluded(ProjectId projectId, int level, const std::string& headerName) override
+    {
+        Model::Module& unit = getProject(projectId).getModule(m_mostRecentModule[projectId]);
+        unit.insertHeader(level, headerName);
+    }
+
+    void projectDone(ProjectId projectId) override
+    {
+        auto node = m_projects.extract(projectId);
+        m_mostRecentModule.erase(projectId);
+
+        Model::Project& project = node.mapped();
+        if (project.isEmpty())
+            return;
+
+        if (m_config.m_simplifyPath)
+            project.simplifyPath();
+
+        m_onProjectParsed(projectId, std::move(project));
+    }
+
+private:
+    Model::Project& getProject(ProjectId projectId)
+    {
+        auto it = m_projects.find(projectId);
+        if (it == m_projects.end())
+            throw Error("Error: project id ", std::to_string(projectId), " does not exist");
+
+        return it->second;
+    }
+};
+
 void MsvcParser::parse(Model& model)
 {
-    std::ifstream compilationLog(m_config.m_inputFile);
-    if (!compilationLog.is_open())
-        throw Error("Error: could not open file ", m_config.m_inputFile);
+    parse(model, m_config.m_inputFile);
+}
+
+void MsvcParser::parse(Model& model, const std::string& fileName)
+{
+    parse(fileName, [&model](ProjectId projectId, Model::Project&& project) { model.addProject(projectId, std::move(project)); });
+}
+
+void MsvcParser::parse(const std::string& fileName, const ProjectCallback& onProjectParsed,
+                       const ProgressCallback& onProgress, std::stop_token stopToken)
+{
+    ProjectBuilder builder(m_config, onProjectParsed);
+    parse(fileName, builder, onProgress, stopToken);
+}
+
+void MsvcParser::parse(const std::string& fileName, Listener& listener,
+                       const ProgressCallback& onProgress, std::stop_token stopToken)
+{
+    LogReader compilationLog(fileName);
+
+    std::error_code sizeError;
+    const std::uintmax_t totalBytes = std::filesystem::file_size(fileName, sizeError);
+    std::uintmax_t bytesParsed = 0;
+    std::uintmax_t nextProgress = 0;
 
     std::string line;
-    while (std::getline(compilationLog, line))
+    while (compilationLog.getLine(line) && !stopToken.stop_requested())
     {
+        bytesParsed = compilationLog.bytesRead();
+        if (onProgress && bytesParsed >= nextProgress)
+        {
+            onProgress(bytesParsed, sizeError ? 0 : totalBytes);
+            nextProgress = bytesParsed + k_progressStep;
+        }
+
         auto maybeModuleLine = splitProjectLine(line);
         if (!maybeModuleLine)
             continue;
@@ -91,17 +188,24 @@ void MsvcParser::parse(Model& model)
         // maybe, it's new project header
         if (auto newProjectName = extractNewProjectName(projectLine); newProjectName)
         {
-            model.addProject(projectId, *newProjectName);
+            // ids are unique within a build, the model rejects a reused one as well
+            if (m_doneProjects.contains(projectId) || !m_activeProjects.insert(projectId).second)
+                throw Error("Error: project id ", std::to_string(projectId), " already exists");
+
+            listener.projectStarted(projectId, *newProjectName);
             continue;
         }
 
-        Model::Project& project = model.getProject(projectId);
+        if (m_doneProjects.contains(projectId))
+            continue;
+
+        if (!m_activeProjects.contains(projectId))
+            throw Error("Error: project id ", std::to_string(projectId), " does not exist");
 
         // ... or it's module line
         if (auto newModuleName = extractModuleName(projectLine); newModuleName)
         {
-            project.addModule(*newModuleName);
-            m_mostRecentModule[projectId] = *newModuleName;
+            listener.moduleStarted(projectId, *newModuleName);
             continue;
         }
 
@@ -109,9 +213,26 @@ void MsvcParser::parse(Model& model)
         if (auto includeNote = extractInculeNote(projectLine, m_config.m_ignoreStd); includeNote)
         {
             HeaderInfo headerInfo = extractHeaderInfo(*includeNote);
-            Model::Module& unit = project.getModule(m_mostRecentModule[projectId]);
-            unit.insertHeader(headerInfo.level, headerInfo.name);
+            listener.headerIncluded(projectId, headerInfo.level, headerInfo.name);
             continue;
         }
+
+        // ... or the project is built and can be shown
+        if (isProjectDone(projectLine))
+        {
+            m_activeProjects.erase(projectId);
+            m_doneProjects.insert(projectId);
+            listener.projectDone(projectId);
+        }
+    }
+
+    while (!m_activeProjects.empty() && !stopToken.stop_requested())
+    {
+        ProjectId projectId = m_activeProjects.extract(m_activeProjects.begin()).value();
+        m_doneProjects.insert(projectId);
+        listener.projectDone(projectId);
     }
+
+    if (onProgress)
+        onProgress(compilationLog.bytesRead(), sizeError ? 0 : totalBytes);
 }
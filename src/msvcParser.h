@@ -1,15 +1,36 @@
 #pragma once
 #include <string>
-#include <map>
+#include <set>
 #include <optional>
+#include <functional>
+#include <stop_token>
 
+#include "model.h"
 
 struct Config;
-class Model;
 
 class MsvcParser
 {
+public:
     using ProjectId = int;
+
+    // called for every non-empty project as soon as its build output is complete
+    using ProjectCallback = std::function<void(ProjectId, Model::Project&&)>;
+    using ProgressCallback = std::function<void(std::uintmax_t bytesParsed, std::uintmax_t totalBytes)>;
+
+    // receives the log as it streams by, nothing is kept by the parser besides the active project ids
+    class Listener
+    {
+    public:
+        virtual ~Listener() = default;
+
+        virtual void projectStarted(ProjectId projectId, const std::string& projectName) = 0;
+        virtual void moduleStarted(ProjectId projectId, const std::string& moduleName) = 0;
+        virtual void headerIncluded(ProjectId projectId, int level, const std::string& headerName) = 0;
+        virtual void projectDone(ProjectId projectId) = 0;     // the rest of the project's output is ignored
+    };
+
+private:
     using HeaderLevel = int;
     struct HeaderInfo
     {
@@ -17,8 +38,13 @@ class MsvcParser
         HeaderLevel level = -1;
     };
 
+    static constexpr std::uintmax_t k_progressStep = 1 << 20;
+
+    class ProjectBuilder;
+
     const Config& m_config;
-    std::map<ProjectId, std::string> m_mostRecentModule;
+    std::set<ProjectId> m_activeProjects;
+    std::set<ProjectId> m_doneProjects;                 // the rest of their output is ignored
 
     static std::optional<std::pair<ProjectId, std::string>> splitProjectLine(const std::string& line);
 
@@ -28,12 +54,18 @@ class MsvcParser
 
     static std::optional<std::string> extractInculeNote(const std::string& line, bool ignoreStd);
 
+    static bool isProjectDone(const std::string& projectLine);
+
     static HeaderInfo extractHeaderInfo(const std::string& headerName);
 
 public:
     MsvcParser(const Config& config) : m_config(config) {}
 
     void parse(Model& model);
+    void parse(Model& model, const std::string& fileName);
+    void parse(const std::string& fileName, const ProjectCallback& onProjectParsed,
+               const ProgressCallback& onProgress = nullptr, std::stop_token stopToken = {});
+    void parse(const std::string& fileName, Listener& listener,
+               const ProgressCallback& onProgress = nullptr, std::stop_token stopToken = {});
 };
 
-
@@ -0,0 +1,155 @@
+#include "pchAdvisor.h"
+#include <cstdint>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+
+namespace
+{
+    // include events of a project in preorder; an occurrence covers the range of its subtree
+    struct Occurrences
+    {
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> m_ranges;
+        std::size_t m_includes = 0;     // sum of the range lengths
+        const Model::Header* m_largest = nullptr;
+        std::uint32_t m_largestSize = 0;
+        std::size_t m_moduleCount = 0;
+        std::size_t m_lastModule = SIZE_MAX;
+    };
+
+    class Coverage
+    {
+        std::vector<std::uint32_t> m_fenwick;       // covered counts
+        std::vector<std::uint32_t> m_nextUncovered; // disjoint set, points to the next uncovered index
+
+        std::uint32_t findUncovered(std::uint32_t index)
+        {
+            std::uint32_t root = index;
+            while (m_nextUncovered[root] != root)
+                root = m_nextUncovered[root];
+
+            while (m_nextUncovered[index] != root)
+                index = std::exchange(m_nextUncovered[index], root);
+
+            return root;
+        }
+
+        std::uint32_t coveredBefore(std::uint32_t end) const
+        {
+            std::uint32_t sum = 0;
+            for (; end > 0; end &= end - 1)
+                sum += m_fenwick[end - 1];
+            return sum;
+        }
+
+    public:
+        explicit Coverage(std::uint32_t size) : m_fenwick(size, 0), m_nextUncovered(size + 1)
+        {
+            for (std::uint32_t i = 0; i <= size; ++i)
+                m_nextUncovered[i] = i;
+        }
+
+        std::uint32_t uncovered(std::uint32_t begin, std::uint32_t end) const
+        {
+            return (end - begin) - (coveredBefore(end) - coveredBefore(begin));
+        }
+
+        void cover(std::uint32_t begin, std::uint32_t end)
+        {
+            for (std::uint32_t i = findUncovered(begin); i < end; i = findUncovered(i))
+            {
+                for (std::uint32_t j = i + 1; j <= m_fenwick.size(); j += j & (~j + 1))
+                    ++m_fenwick[j - 1];
+                m_nextUncovered[i] = i + 1;
+            }
+        }
+    };
+
+    void enumerate(const Model::Header& header, std::size_t moduleIndex, std::uint32_t& position,
+                   std::unordered_map<Model::HeaderId, Occurrences>& occurrences)
+    {
+        std::uint32_t begin = position++;
+        for (const Model::Header& child : header.children())
+            enumerate(child, moduleIndex, position, occurrences);
+
+        // nested in an occurrence of the same header, its range is covered already and would count twice
+        if (header.isCycle())
+            return;
+
+        Occurrences& found = occurrences[header.id()];
+        found.m_ranges.emplace_back(begin, position);
+        found.m_includes += position - begin;
+        if (position - begin > found.m_largestSize)
+        {
+            found.m_largestSize = position - begin;
+            found.m_largest = &header;
+        }
+        if (found.m_lastModule != moduleIndex)
+        {
+            found.m_lastModule = moduleIndex;
+            ++found.m_moduleCount;
+        }
+    }
+}
+
+PchAdvisor::PchAdvisor(std::size_t maxHeaders, std::size_t maxPchIncludes)
+    : m_maxHeaders(maxHeaders)
+    , m_maxPchIncludes(maxPchIncludes)
+{
+    if (m_maxHeaders == 0 && m_maxPchIncludes == 0)
+        m_maxHeaders = k_defaultMaxHeaders;
+}
+
+PchAdvisor::Recommendation PchAdvisor::recommend(const Model::Project& project) const
+{
+    std::unordered_map<Model::HeaderId, Occurrences> occurrences;
+    std::uint32_t position = 0;
+    std::size_t moduleIndex = 0;
+    for (const auto& [_, unit] : project.modules())
+    {
+        for (const Model::Header& header : unit.headers())
+            enumerate(header, moduleIndex, position, occurrences);
+        ++moduleIndex;
+    }
+
+    Recommendation recommendation;
+    recommendation.m_totalIncludes = position;
+
+    // lazy greedy: a stale gain is an upper bound, re-evaluate only the top of the queue
+    using Gain = std::pair<std::size_t, Model::HeaderId>;
+    std::priority_queue<Gain> queue;
+    for (const auto& [id, found] : occurrences)
+        if (found.m_moduleCount > 1)    // a header used by a single module is no shared cost
+            queue.emplace(found.m_includes, id);
+
+    Coverage coverage(position);
+    while (!queue.empty() && (m_maxHeaders == 0 || recommendation.m_headers.size() < m_maxHeaders))
+    {
+        Model::HeaderId id = queue.top().second;
+        queue.pop();
+
+        const Occurrences& found = occurrences[id];
+        std::size_t gain = 0;
+        for (auto [begin, end] : found.m_ranges)
+            gain += coverage.uncovered(begin, end);
+
+        if (gain == 0)
+            continue;
+        if (!queue.empty() && gain < queue.top().first)
+        {
+            queue.emplace(gain, id);
+            continue;
+        }
+        if (m_maxPchIncludes != 0 && recommendation.m_pchIncludes + found.m_largestSize > m_maxPchIncludes)
+            continue;
+
+        for (auto [begin, end] : found.m_ranges)
+            coverage.cover(begin, end);
+
+        recommendation.m_headers.push_back(Candidate{ found.m_largest, found.m_moduleCount, gain });
+        recommendation.m_savedIncludes += gain;
+        recommendation.m_pchIncludes += found.m_largestSize;
+    }
+
+    return recommendation;
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <vector>
+
+#include "model.h"
+
+// Picks headers to precompile for a project: the ones that, together, cover the most include events.
+// Coverage is submodular, so a lazy greedy selection is used; it is within (1 - 1/e) of the optimum.
+class PchAdvisor
+{
+public:
+    static constexpr std::size_t k_defaultMaxHeaders = 32;
+
+    struct Candidate
+    {
+        const Model::Header* m_header = nullptr;    // the largest occurrence
+        std::size_t m_moduleCount = 0;              // modules including the header
+        std::size_t m_savedIncludes = 0;            // include events not covered by better candidates
+    };
+
+    struct Recommendation
+    {
+        std::vector<Candidate> m_headers;
+        std::size_t m_savedIncludes = 0;
+        std::size_t m_totalIncludes = 0;
+        std::size_t m_pchIncludes = 0;      // headers in the precompiled set, sum of the largest subtrees
+    };
+
+    // 0 means no limit; if both are 0, k_defaultMaxHeaders is used
+    PchAdvisor(std::size_t maxHeaders, std::size_t maxPchIncludes);
+
+    Recommendation recommend(const Model::Project& project) const;
+
+private:
+    std::size_t m_maxHeaders;
+    std::size_t m_maxPchIncludes;
+};
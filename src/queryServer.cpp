@@ -0,0 +1,538 @@
+#include "queryServer.h"
+#include "config.h"
+#include "error.h"
+#include "jsonReader.h"
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <winsock2.h>
+    #include <afunix.h>
+#else
+    #include <sys/socket.h>
+    #include <sys/un.h>
+    #include <unistd.h>
+#endif
+
+namespace
+{
+#ifdef _WIN32
+    using NativeSocket = SOCKET;
+    const NativeSocket k_invalidSocket = INVALID_SOCKET;
+    const int k_sendFlags = 0;
+
+    void closeSocket(NativeSocket socket) { closesocket(socket); }
+    int lastSocketError() { return WSAGetLastError(); }
+
+    // the pending connection failed, the next one may succeed
+    bool isConnectionError(int error) { return error == WSAEINTR || error == WSAECONNRESET || error == WSAECONNABORTED; }
+    bool isOutOfResources(int error)  { return error == WSAEMFILE || error == WSAENOBUFS; }
+#else
+    using NativeSocket = int;
+    const NativeSocket k_invalidSocket = -1;
+  #ifdef MSG_NOSIGNAL
+    const int k_sendFlags = MSG_NOSIGNAL;   // a client gone mid-response must not kill the daemon
+  #else
+    const int k_sendFlags = 0;
+  #endif
+
+    void closeSocket(NativeSocket socket) { close(socket); }
+    int lastSocketError() { return errno; }
+
+    // the pending connection failed, the next one may succeed
+    bool isConnectionError(int error) { return error == EINTR || error == ECONNABORTED || error == EPROTO; }
+    bool isOutOfResources(int error)  { return error == EMFILE || error == ENFILE || error == ENOBUFS || error == ENOMEM; }
+#endif
+
+    void collectCycles(const Model::Header& header, std::vector<const Model::Header*>& path,
+                       std::vector<std::vector<const Model::Header*>>& cycles)
+    {
+        path.push_back(&header);
+        if (header.isCycle())
+            cycles.push_back(path);
+
+        for (const Model::Header& child : header.children())
+            if (child.hasCycle() || child.isCycle())
+                collectCycles(child, path, cycles);
+
+        path.pop_back();
+    }
+}
+
+// owns a socket, reads requests line by line
+class QueryServer::Connection
+{
+    NativeSocket m_socket;
+    std::string m_buffer;
+
+public:
+    explicit Connection(NativeSocket socket) : m_socket(socket) {}
+    Connection(Connection&& other) noexcept : m_socket(std::exchange(other.m_socket, k_invalidSocket)), m_buffer(std::move(other.m_buffer)) {}
+    Connection& operator=(Connection&&) = delete;
+
+    ~Connection()
+    {
+        if (m_socket != k_invalidSocket)
+            closeSocket(m_socket);
+    }
+
+    NativeSocket socket() const { return m_socket; }
+
+    // false when the client is gone or sends a line longer than k_maxRequestSize
+    bool readLine(std::string& line)
+    {
+        for (std::size_t searchFrom = 0; ; )
+        {
+            if (std::size_t end = m_buffer.find('\n', searchFrom); end != std::string::npos)
+            {
+                line.assign(m_buffer, 0, end);
+                if (!line.empty() && line.back() == '\r')
+                    line.pop_back();
+
+                m_buffer.erase(0, end + 1);
+                return true;
+            }
+
+            if (m_buffer.size() > k_maxRequestSize)
+                return false;
+
+            searchFrom = m_buffer.size();
+            char chunk[4096];
+            auto received = recv(m_socket, chunk, static_cast<int>(sizeof(chunk)), 0);
+            if (received <= 0)
+                return false;
+
+            m_buffer.append(chunk, static_cast<std::size_t>(received));
+        }
+    }
+
+    bool write(std::string_view data)
+    {
+        while (!data.empty())
+        {
+            auto sent = send(m_socket, data.data(), static_cast<int>(data.size()), k_sendFlags);
+            if (sent <= 0)
+                return false;
+
+            data.remove_prefix(static_cast<std::size_t>(sent));
+        }
+        return true;
+    }
+};
+
+QueryServer::QueryServer(const Config& config, Loader loader)
+    : m_config(config)
+    , m_loader(std::move(loader))
+    , m_state(std::make_shared<State>())
+{
+    m_state->m_logFile = m_config.m_inputFile;
+}
+
+void QueryServer::run()
+{
+#ifdef _WIN32
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0)
+        throw Error("Error: could not initialize sockets");
+#endif
+
+    const std::string& path = m_config.m_serveSocket;
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path))
+        throw Error("Error: socket path is too long: ", path);
+    std::copy(path.begin(), path.end(), address.sun_path);
+
+    // load before listening, so the first request doesn't wait
+    LogStamp loaded = logStamp(m_config.m_inputFile);
+    load();
+
+    Connection listener(::socket(AF_UNIX, SOCK_STREAM, 0));
+    if (listener.socket() == k_invalidSocket)
+        throw Error("Error: could not create socket ", path);
+
+    // a socket file left by a previous run is reused, unless someone still serves it
+    if (std::error_code error; std::filesystem::exists(path, error))
+    {
+        Connection probe(::socket(AF_UNIX, SOCK_STREAM, 0));
+        if (connect(probe.socket(), reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0)
+            throw Error("Error: ", path, " is already served by another process");
+        if (!std::filesystem::is_socket(path, error))
+            throw Error("Error: ", path, " exists and is not a socket");
+
+        std::filesystem::remove(path, error);
+    }
+
+    if (bind(listener.socket(), reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0
+        || listen(listener.socket(), SOMAXCONN) != 0)
+    {
+        throw Error("Error: could not listen on ", path);
+    }
+
+    m_watcher = std::jthread([this, loaded](std::stop_token stopToken) { watchLog(stopToken, loaded); });
+    std::cout << "Serving queries on " << path << std::endl;
+
+    for (bool isBackingOff = false; ; )
+    {
+        {
+            std::unique_lock lock(m_state->m_mutex);
+            m_state->m_connectionDone.wait(lock, [this] { return m_state->m_connections < k_maxConnections; });
+        }
+
+        NativeSocket client = accept(listener.socket(), nullptr, nullptr);
+        if (client == k_invalidSocket)
+        {
+            int error = lastSocketError();
+            if (isConnectionError(error))
+                continue;
+            if (!isOutOfResources(error))
+                throw Error("Error: could not accept a connection on ", path, ": ", std::system_category().message(error));
+
+            // descriptors are freed as connections close, retrying at once would only spin
+            if (!std::exchange(isBackingOff, true))
+                std::cerr << "Warning: could not accept a connection, " << std::system_category().message(error) << ", retrying" << std::endl;
+            std::this_thread::sleep_for(k_acceptBackoff);
+            continue;
+        }
+
+        isBackingOff = false;
+        startServing(Connection(client));
+    }
+}
+
+void QueryServer::startServing(Connection connection)
+{
+    {
+        std::lock_guard lock(m_state->m_mutex);
+        ++m_state->m_connections;
+    }
+
+    try
+    {
+        std::thread(&QueryServer::serve, std::move(connection), m_state).detach();
+    }
+    catch (const std::system_error& e)
+    {
+        // out of threads: the connection is closed, the client may retry
+        std::cerr << "Warning: could not serve a connection, " << e.what() << std::endl;
+        connectionDone(*m_state);
+    }
+}
+
+void QueryServer::connectionDone(State& state)
+{
+    {
+        std::lock_guard lock(state.m_mutex);
+        --state.m_connections;
+    }
+    state.m_connectionDone.notify_one();
+}
+
+void QueryServer::load()
+{
+    Snapshot model = std::make_shared<const Model>(m_loader());
+
+    std::lock_guard lock(m_state->m_mutex);
+    m_state->m_model = std::move(model);
+    ++m_state->m_generation;
+}
+
+QueryServer::LogStamp QueryServer::logStamp(const std::string& fileName)
+{
+    std::error_code error;
+    return LogStamp(std::filesystem::last_write_time(fileName, error), std::filesystem::file_size(fileName, error));
+}
+
+void QueryServer::watchLog(std::stop_token stopToken, LogStamp loaded)
+{
+    std::mutex mutex;
+    std::condition_variable_any wakeUp;
+    std::unique_lock lock(mutex);
+
+    LogStamp previous = loaded;
+    while (!wakeUp.wait_for(lock, stopToken, k_reloadPollInterval, [] { return false; }) && !stopToken.stop_requested())
+    {
+        // a build may still be writing the log, reload once it stays the same for a poll interval
+        LogStamp current = logStamp(m_config.m_inputFile);
+        bool isSettled = current == previous;
+        previous = current;
+        if (!isSettled || current == loaded)
+            continue;
+
+        loaded = current;
+        try
+        {
+            load();
+            std::cout << "Reloaded " << m_config.m_inputFile << std::endl;
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << e.what() << ", keeping the previous model" << std::endl;
+        }
+    }
+}
+
+void QueryServer::serve(Connection connection, std::shared_ptr<State> state)
+{
+    std::string line;
+    while (connection.readLine(line))
+    {
+        if (line.find_first_not_of(" \t") == std::string::npos)
+            continue;
+
+        if (!connection.write(answer(line, *state)))
+            break;
+    }
+
+    connectionDone(*state);
+}
+
+std::string QueryServer::answer(const std::string& line, State& state)
+{
+    Request request;
+    std::string response;
+    try
+    {
+        parseRequest(line, request);
+
+        Snapshot model;
+        std::uint64_t generation = 0;
+        {
+            std::lock_guard lock(state.m_mutex);
+            model = state.m_model;
+            generation = state.m_generation;
+        }
+
+        std::string result;
+        if (request.m_query == "includers")
+        {
+            includers(*model, request, result);
+        }
+        else if (request.m_query == "subtree")
+        {
+            subtree(*model, request, result);
+        }
+        else if (request.m_query == "cycles")
+        {
+            cycles(*model, request, result);
+        }
+        else if (request.m_query == "stats")
+        {
+            std::size_t moduleCount = 0;
+            for (const auto& [_, project] : model->projects())
+                moduleCount += project.modules().size();
+
+            result = "{\"log\":";
+            appendString(result, state.m_logFile);
+            result += ",\"generation\":" + std::to_string(generation)
+                + ",\"projects\":" + std::to_string(model->projects().size())
+                + ",\"modules\":" + std::to_string(moduleCount)
+                + ",\"headers\":" + std::to_string(model->headerCount()) + "}";
+        }
+        else
+        {
+            throw Error("Error: unknown query '", request.m_query, "'");
+        }
+
+        response = "{\"id\":" + request.m_id + ",\"ok\":true,\"result\":" + result + "}\n";
+    }
+    catch (const std::exception& e)
+    {
+        response = "{\"id\":" + request.m_id + ",\"ok\":false,\"error\":";
+        appendString(response, e.what());
+        response += "}\n";
+    }
+
+    return response;
+}
+
+void QueryServer::parseRequest(const std::string& line, Request& request)
+{
+    using Token = JsonReader::Token;
+
+    std::istringstream input(line);
+    JsonReader reader(input);
+    if (reader.next() != Token::BeginObject)
+        throw Error("Error: a request must be a JSON object");
+
+    for (Token token = reader.next(); token != Token::EndObject; token = reader.next())
+    {
+        if (token != Token::Key)
+            throw Error("Error: malformed request");
+
+        std::string key = reader.string();
+        Token value = reader.next();
+        if (key == "id" && (value == Token::Number || value == Token::String))
+        {
+            request.m_id.clear();
+            if (value == Token::String)
+            {
+                appendString(request.m_id, reader.string());
+            }
+            else
+            {
+                char number[32];
+                std::snprintf(number, sizeof(number), "%.17g", reader.number());
+                request.m_id = number;
+            }
+            continue;
+        }
+
+        std::string* field = key == "query" ? &request.m_query
+                           : key == "header" ? &request.m_header
+                           : key == "module" ? &request.m_module
+                           : key == "project" ? &request.m_project
+                           : nullptr;
+        if (field && value == Token::String)
+            *field = reader.string();
+        else
+            reader.skip(value);
+    }
+}
+
+void QueryServer::includers(const Model& model, const Request& request, std::string& result)
+{
+    if (request.m_header.empty())
+        throw Error("Error: 'header' is required");
+
+    result += '[';
+    for (Model::HeaderId id : model.findHeaders(request.m_header))
+    {
+        const std::vector<Model::Includer>& includers = model.includers(id);
+        if (result.size() > 1)
+            result += ',';
+
+        result += "{\"header\":";
+        appendString(result, includers.front().m_header->name());
+        result += ",\"includers\":[";
+        for (const Model::Includer& includer : includers)
+        {
+            if (&includer != &includers.front())
+                result += ',';
+
+            result += "{\"project\":";
+            appendString(result, includer.m_project->name());
+            result += ",\"module\":";
+            appendString(result, includer.m_module->name());
+            result += ",\"parent\":";
+            if (includer.m_parent)
+                appendString(result, includer.m_parent->name());
+            else
+                result += "null";   // included by the module itself
+            result += '}';
+        }
+        result += "]}";
+    }
+    result += ']';
+}
+
+void QueryServer::subtree(const Model& model, const Request& request, std::string& result)
+{
+    if (request.m_header.empty())
+        throw Error("Error: 'header' is required");
+
+    result += '[';
+    for (Model::HeaderId id : model.findHeaders(request.m_header))
+    {
+        const std::vector<Model::Includer>& includers = model.includers(id);
+        std::size_t maxSize = 0;
+        std::size_t totalSize = 0;
+        for (const Model::Includer& includer : includers)
+        {
+            maxSize = std::max(maxSize, includer.m_header->subtreeSize());
+            totalSize += includer.m_header->subtreeSize();
+        }
+
+        if (result.size() > 1)
+            result += ',';
+
+        result += "{\"header\":";
+        appendString(result, includers.front().m_header->name());
+        result += ",\"occurrences\":" + std::to_string(includers.size())
+            + ",\"maxSubtreeSize\":" + std::to_string(maxSize)
+            + ",\"totalSubtreeSize\":" + std::to_string(totalSize) + "}";
+    }
+    result += ']';
+}
+
+void QueryServer::cycles(const Model& model, const Request& request, std::string& result)
+{
+    bool isModuleFound = request.m_module.empty();
+    std::vector<const Model::Header*> path;
+    std::vector<std::vector<const Model::Header*>> found;
+
+    result += '[';
+    for (const auto& [_, project] : model.projects())
+    {
+        if (!request.m_project.empty() && project.name() != request.m_project)
+            continue;
+
+        for (const auto& [name, unit] : project.modules())
+        {
+            if (!request.m_module.empty() && name != request.m_module)
+                continue;
+
+            isModuleFound = true;
+            found.clear();
+            for (const Model::Header& header : unit.headers())
+                if (header.hasCycle() || header.isCycle())
+                    collectCycles(header, path, found);
+
+            for (const std::vector<const Model::Header*>& cycle : found)
+            {
+                if (result.size() > 1)
+                    result += ',';
+
+                result += "{\"project\":";
+                appendString(result, project.name());
+                result += ",\"module\":";
+                appendString(result, name);
+                result += ",\"chain\":[";
+                for (const Model::Header* header : cycle)
+                {
+                    if (header != cycle.front())
+                        result += ',';
+                    appendString(result, header->name());
+                }
+                result += "]}";
+            }
+        }
+    }
+    result += ']';
+
+    if (!isModuleFound)
+        throw Error("Error: module '", request.m_module, "' not found");
+}
+
+void QueryServer::appendString(std::string& out, std::string_view value)
+{
+    out += '"';
+    for (char c : value)
+    {
+        if (c == '"' || c == '\\')
+        {
+            out += '\\';
+            out += c;
+        }
+        else if (static_cast<unsigned char>(c) < 0x20)
+        {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+            out += escaped;
+        }
+        else
+        {
+            out += c;   // UTF-8 is passed through
+        }
+    }
+    out += '"';
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <thread>
+
+#include "model.h"
+
+struct Config;
+
+// Resident daemon answering line-delimited JSON queries over a local Unix domain socket.
+// The model is loaded once; requests run concurrently against an immutable snapshot of it,
+// and the log is reloaded in the background when it changes.
+//
+// One request per line, one response line per request:
+//   {"id": 1, "query": "includers", "header": "foo.h"}
+//   {"id": 2, "query": "subtree", "header": "foo.h"}
+//   {"id": 3, "query": "cycles", "module": "bar.cpp", "project": "optional"}
+//   {"id": 4, "query": "stats"}
+//   -> {"id": 1, "ok": true, "result": ...} or {"id": 1, "ok": false, "error": "..."}
+// Subtree sizes count the header itself and all of its nested includes.
+// At most k_maxConnections clients are served at once, the next ones wait in the listen backlog.
+class QueryServer
+{
+public:
+    using Loader = std::function<Model()>;
+
+    QueryServer(const Config& config, Loader loader);
+
+    QueryServer(const QueryServer&) = delete;
+    QueryServer& operator=(const QueryServer&) = delete;
+
+    void run();     // serves until the process is stopped
+
+private:
+    using Snapshot = std::shared_ptr<const Model>;
+    using LogStamp = std::pair<std::filesystem::file_time_type, std::uintmax_t>;  // modified, size
+
+    static constexpr auto k_reloadPollInterval = std::chrono::seconds(1);
+    static constexpr std::size_t k_maxRequestSize = 1 << 20;
+    static constexpr std::size_t k_maxConnections = 64;
+    static constexpr auto k_acceptBackoff = std::chrono::milliseconds(100);   // out of descriptors
+
+    // shared with the connection threads, they are detached and may outlive the server
+    struct State
+    {
+        std::mutex m_mutex;
+        Snapshot m_model;
+        std::uint64_t m_generation = 0;     // reloads so far
+        std::string m_logFile;
+        std::size_t m_connections = 0;      // being served
+        std::condition_variable m_connectionDone;
+    };
+
+    struct Request
+    {
+        std::string m_id = "null";          // echoed as is, JSON text
+        std::string m_query;
+        std::string m_header;
+        std::string m_module;
+        std::string m_project;
+    };
+
+    class Connection;
+
+    const Config& m_config;
+    Loader m_loader;
+    std::shared_ptr<State> m_state;
+    std::jthread m_watcher;
+
+    void load();
+    void watchLog(std::stop_token stopToken, LogStamp loaded);
+    static LogStamp logStamp(const std::string& fileName);
+
+    void startServing(Connection connection);
+    static void serve(Connection connection, std::shared_ptr<State> state);
+    static void connectionDone(State& state);
+    static std::string answer(const std::string& line, State& state);
+    static void parseRequest(const std::string& line, Request& request);
+
+    static void includers(const Model& model, const Request& request, std::string& result);
+    static void subtree(const Model& model, const Request& request, std::string& result);
+    static void cycles(const Model& model, const Request& request, std::string& result);
+
+    static void appendString(std::string& out, std::string_view value);
+};
@@ -0,0 +1,53 @@
+#include "rebuildImpact.h"
+#include <algorithm>
+
+RebuildImpact::RebuildImpact(const Model& model)
+    : m_dependentModules(model.headerCount())
+{
+    for (const auto& [_, project] : model.projects())
+    {
+        ProjectRange range{ &project, m_moduleCount, m_moduleCount };
+        for (const auto& [_, unit] : project.modules())
+        {
+            // module indices only grow, so every set() appends to the bitset
+            for (const Model::Header& header : unit.headers())
+                addModule(header, m_moduleCount);
+            ++m_moduleCount;
+        }
+
+        range.m_end = m_moduleCount;
+        m_projects.push_back(range);
+    }
+
+    for (Model::HeaderId id = 0; id < m_dependentModules.size(); ++id)
+        if (std::size_t count = m_dependentModules[id].count(); count > 0)
+            m_ranking.push_back(Impact{ id, model.includers(id).front().m_header, count });
+
+    std::sort(m_ranking.begin(), m_ranking.end(), [](const Impact& left, const Impact& right)
+        {
+            return left.m_moduleCount != right.m_moduleCount ? left.m_moduleCount > right.m_moduleCount : left.m_id < right.m_id;
+        });
+}
+
+void RebuildImpact::addModule(const Model::Header& header, std::uint32_t moduleIndex)
+{
+    m_dependentModules[header.id()].set(moduleIndex);
+    for (const Model::Header& child : header.children())
+        addModule(child, moduleIndex);
+}
+
+std::vector<RebuildImpact::ProjectImpact> RebuildImpact::byProject(const Impact& impact) const
+{
+    const SparseBitset& modules = m_dependentModules[impact.m_id];
+
+    std::vector<ProjectImpact> projects;
+    for (const ProjectRange& range : m_projects)
+        if (std::size_t count = modules.count(range.m_begin, range.m_end); count > 0)
+            projects.push_back(ProjectImpact{ range.m_project, count });
+
+    std::stable_sort(projects.begin(), projects.end(), [](const ProjectImpact& left, const ProjectImpact& right)
+        {
+            return left.m_moduleCount > right.m_moduleCount;
+        });
+    return projects;
+}
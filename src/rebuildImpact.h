@@ -0,0 +1,47 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "model.h"
+
+// "Touch it and N modules rebuild": for every header, the modules having it anywhere in their include trees.
+// Each header gets a bitset over the module indices, filled in one pass over the trees. Modules of a project
+// have consecutive indices, so the per-project breakdown counts a range of the bitset.
+class RebuildImpact
+{
+public:
+    struct Impact
+    {
+        Model::HeaderId m_id = 0;
+        const Model::Header* m_header = nullptr;    // the first occurrence
+        std::size_t m_moduleCount = 0;
+    };
+
+    struct ProjectImpact
+    {
+        const Model::Project* m_project = nullptr;
+        std::size_t m_moduleCount = 0;              // modules of the project to rebuild
+    };
+
+    explicit RebuildImpact(const Model& model);
+
+    std::size_t moduleCount() const { return m_moduleCount; }
+    const std::vector<Impact>& ranking() const { return m_ranking; }   // most modules first
+
+    std::vector<ProjectImpact> byProject(const Impact& impact) const;  // most modules first
+
+private:
+    struct ProjectRange
+    {
+        const Model::Project* m_project = nullptr;
+        std::uint32_t m_begin = 0;
+        std::uint32_t m_end = 0;
+    };
+
+    std::vector<SparseBitset> m_dependentModules;   // by header id
+    std::vector<ProjectRange> m_projects;
+    std::vector<Impact> m_ranking;
+    std::uint32_t m_moduleCount = 0;
+
+    void addModule(const Model::Header& header, std::uint32_t moduleIndex);
+};
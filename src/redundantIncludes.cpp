@@ -0,0 +1,34 @@
+#include "redundantIncludes.h"
+#include <algorithm>
+
+RedundantIncludes::RedundantIncludes(const Model& model)
+{
+    for (const auto& [_, project] : model.projects())
+        for (const auto& [_, unit] : project.modules())
+            checkSiblings(project, unit, nullptr, unit.headers());
+}
+
+void RedundantIncludes::checkSiblings(const Model::Project& project, const Model::Module& unit, const Model::Header* parent,
+                                      const std::vector<Model::Header>& siblings)
+{
+    SparseBitset included;  // by the siblings checked so far
+    for (auto it = siblings.begin(); it != siblings.end(); ++it)
+    {
+        const Model::Header& header = *it;
+        if (included.test(header.id()))
+        {
+            // rare: find the culprit by a linear scan
+            auto via = std::find_if(siblings.begin(), it, [id = header.id()](const Model::Header& sibling)
+                {
+                    return sibling.id() == id || sibling.reachable().test(id);
+                });
+
+            m_findings.push_back(Finding{ &project, &unit, parent, &header, &*via });
+        }
+
+        included.set(header.id());
+        included.unite(header.reachable());
+
+        checkSiblings(project, unit, &header, header.children());
+    }
+}
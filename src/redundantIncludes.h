@@ -0,0 +1,30 @@
+#pragma once
+#include <vector>
+
+#include "model.h"
+
+// Direct includes that were already brought in by an earlier sibling, e.g. "x.h" includes "y.h" after "z.h" did.
+// MSVC lists such a header again only when it lacks include guards, so every finding is a real re-parse.
+// The model must have reachable header sets updated.
+class RedundantIncludes
+{
+public:
+    struct Finding
+    {
+        const Model::Project* m_project = nullptr;
+        const Model::Module* m_module = nullptr;
+        const Model::Header* m_parent = nullptr;    // nullptr if included directly by the module
+        const Model::Header* m_header = nullptr;
+        const Model::Header* m_via = nullptr;       // the earlier sibling which already included m_header
+    };
+
+    explicit RedundantIncludes(const Model& model);
+
+    const std::vector<Finding>& findings() const { return m_findings; }
+
+private:
+    std::vector<Finding> m_findings;
+
+    void checkSiblings(const Model::Project& project, const Model::Module& unit, const Model::Header* parent,
+                       const std::vector<Model::Header>& siblings);
+};
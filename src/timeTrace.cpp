@@ -0,0 +1,220 @@
+#include "timeTrace.h"
+#include "jsonReader.h"
+#include "error.h"
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <limits>
+
+TimeTrace::TimeTrace(const std::string& path)
+{
+    auto addTrace = [this, &path](const std::filesystem::path& trace)
+        {
+            Trace added{ trace, {} };
+            for (const std::filesystem::path& directory : trace.lexically_relative(path).parent_path())
+                added.m_directories.push_back(lowerFileName(directory.string()));
+
+            // "foo.json" and "foo.cpp.json" both belong to foo.cpp
+            m_traces.emplace(stem(lowerFileName(trace.stem().string())), std::move(added));
+        };
+
+    if (std::filesystem::is_directory(path))
+    {
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(path))
+            if (entry.is_regular_file() && entry.path().extension() == ".json")
+                addTrace(entry.path());
+    }
+    else if (std::filesystem::is_regular_file(path))
+    {
+        addTrace(path);
+    }
+    else
+    {
+        throw Error("Error: could not find time trace ", path);
+    }
+}
+
+void TimeTrace::attach(Model::Project& project)
+{
+    for (auto& [name, unit] : project.modules())
+        if (Trace* trace = findTrace(project, name); trace)
+            attach(unit, readSourceEvents(trace->m_path));
+}
+
+TimeTrace::Trace* TimeTrace::findTrace(const Model::Project& project, const std::string& moduleName)
+{
+    auto [begin, end] = m_traces.equal_range(stem(lowerFileName(moduleName)));
+    if (begin == end)
+        return nullptr;
+
+    std::vector<Trace*> candidates;
+    for (auto it = begin; it != end; ++it)
+        candidates.push_back(&it->second);
+
+    if (candidates.size() > 1)
+    {
+        // e.g. pch.cpp of several projects: keep the traces under a directory named after this project
+        std::string projectName = lowerFileName(project.name());
+        std::erase_if(candidates, [&projectName](const Trace* trace)
+            {
+                return std::find(trace->m_directories.begin(), trace->m_directories.end(), projectName) == trace->m_directories.end();
+            });
+    }
+
+    if (candidates.size() == 1 && !candidates.front()->m_isAttached)
+    {
+        candidates.front()->m_isAttached = true;
+        return candidates.front();
+    }
+
+    std::string reason = candidates.empty() ? "several traces match, none in a '" + project.name() + "' directory"
+                       : candidates.size() > 1 ? std::to_string(candidates.size()) + " traces match"
+                       : "the trace is already used by another module";
+    m_warnings.push_back("Warning: no time trace for " + project.name() + " / " + moduleName + ", " + reason);
+    return nullptr;
+}
+
+std::string TimeTrace::stem(std::string_view fileName)
+{
+    return std::string(fileName.substr(0, fileName.find('.')));
+}
+
+std::string TimeTrace::lowerFileName(std::string_view path)
+{
+    std::string_view::size_type separator = path.find_last_of("\\/");
+    std::string fileName(separator == std::string_view::npos ? path : path.substr(separator + 1));
+    std::transform(fileName.begin(), fileName.end(), fileName.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return fileName;
+}
+
+std::vector<TimeTrace::SourceEvent> TimeTrace::readSourceEvents(const std::filesystem::path& trace)
+{
+    using Token = JsonReader::Token;
+
+    std::ifstream input(trace, std::ios::binary);
+    if (!input.is_open())
+        throw Error("Error: could not open file ", trace.string());
+
+    // {"traceEvents": [{"ph": "X", "name": "Source", "ts": 1, "dur": 2, "args": {"detail": "path"}}, ...], ...}
+    std::vector<SourceEvent> events;
+    JsonReader reader(input);
+    for (Token token = reader.next(); token != Token::End; token = reader.next())
+    {
+        if (token != Token::BeginObject || reader.depth() != 3)
+            continue;
+
+        SourceEvent event;
+        bool isSource = false;
+        bool isComplete = false;
+        for (token = reader.next(); token == Token::Key; token = reader.next())
+        {
+            const std::string& key = reader.string();   // valid until the next token
+            if (key == "name")
+            {
+                reader.next();
+                isSource = reader.string() == "Source";
+            }
+            else if (key == "ph")
+            {
+                reader.next();
+                isComplete = reader.string() == "X";
+            }
+            else if (key == "ts")
+            {
+                reader.next();
+                event.m_begin = reader.number();
+            }
+            else if (key == "dur")
+            {
+                reader.next();
+                event.m_duration = reader.number();
+            }
+            else if (key == "args")
+            {
+                if (token = reader.next(); token != Token::BeginObject)
+                {
+                    reader.skip(token);
+                    continue;
+                }
+
+                for (token = reader.next(); token == Token::Key; token = reader.next())
+                {
+                    if (reader.string() != "detail")
+                        reader.skipValue();
+                    else if (token = reader.next(); token == Token::String)
+                        event.m_fileName = lowerFileName(reader.string());
+                    else
+                        reader.skip(token);
+                }
+            }
+            else
+            {
+                reader.skipValue();
+            }
+        }
+
+        if (isSource && isComplete)
+            events.push_back(std::move(event));
+    }
+
+    return events;
+}
+
+void TimeTrace::attach(Model::Module& unit, std::vector<SourceEvent> events)
+{
+    // parents start earlier, or at the same time but last longer
+    std::sort(events.begin(), events.end(), [](const SourceEvent& left, const SourceEvent& right)
+        {
+            return left.m_begin < right.m_begin || (left.m_begin == right.m_begin && left.m_duration > right.m_duration);
+        });
+
+    struct Level
+    {
+        double m_end;
+        double m_duration;
+        double m_childrenDuration;
+        Model::Header* m_header;                    // nullptr if the event has no match in the tree
+        std::vector<Model::Header>* m_children;
+        std::size_t m_cursor;                       // includes before it are already matched
+    };
+
+    auto close = [](const Level& level)
+        {
+            if (level.m_header)
+                level.m_header->addTime(level.m_duration / 1000, (level.m_duration - level.m_childrenDuration) / 1000);
+        };
+
+    std::vector<Level> stack = { Level{ std::numeric_limits<double>::infinity(), 0, 0, nullptr, &unit.headers(), 0 } };
+    for (const SourceEvent& event : events)
+    {
+        while (event.m_begin >= stack.back().m_end)
+        {
+            close(stack.back());
+            stack.pop_back();
+        }
+
+        Level& parent = stack.back();
+        parent.m_childrenDuration += event.m_duration;
+
+        Model::Header* match = nullptr;
+        if (parent.m_children)
+        {
+            std::vector<Model::Header>& children = *parent.m_children;
+            auto it = std::find_if(children.begin() + parent.m_cursor, children.end(), [&event](const Model::Header& child)
+                {
+                    return lowerFileName(child.normalizedName()) == event.m_fileName;
+                });
+
+            if (it != children.end())
+            {
+                match = &*it;
+                parent.m_cursor = std::distance(children.begin(), it) + 1;
+            }
+        }
+
+        stack.push_back(Level{ event.m_begin + event.m_duration, event.m_duration, 0, match, match ? &match->children() : nullptr, 0 });
+    }
+
+    for (; stack.size() > 1; stack.pop_back())
+        close(stack.back());
+}
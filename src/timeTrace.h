@@ -0,0 +1,50 @@
+#pragma once
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "model.h"
+
+// Frontend times from clang -ftime-trace JSON files, one file per translation unit.
+// "Source" events are matched to the include tree of the module with the same file stem
+// (foo.json or foo.cpp.json belong to foo.cpp), then nested events to nested headers in include order.
+// Same-stem traces of several projects (pch.cpp, main.cpp) are told apart by a directory named after
+// the project; a module gets at most one trace, an ambiguous match is skipped with a warning.
+class TimeTrace
+{
+public:
+    explicit TimeTrace(const std::string& path);    // a trace file or a directory with traces
+
+    std::size_t traceCount() const { return m_traces.size(); }
+
+    // reads the traces of the project's modules and adds their times to the headers
+    void attach(Model::Project& project);
+
+    const std::vector<std::string>& warnings() const { return m_warnings; }
+
+private:
+    struct Trace
+    {
+        std::filesystem::path m_path;
+        std::vector<std::string> m_directories;     // lower case, relative to the traces root
+        bool m_isAttached = false;
+    };
+
+    struct SourceEvent
+    {
+        double m_begin = 0;         // microseconds
+        double m_duration = 0;
+        std::string m_fileName;     // lower case, without directory
+    };
+
+    std::unordered_multimap<std::string, Trace> m_traces;   // lower case stem -> trace file
+    std::vector<std::string> m_warnings;
+
+    Trace* findTrace(const Model::Project& project, const std::string& moduleName);
+
+    static std::string stem(std::string_view fileName);
+    static std::string lowerFileName(std::string_view path);
+    static std::vector<SourceEvent> readSourceEvents(const std::filesystem::path& trace);
+    static void attach(Model::Module& unit, std::vector<SourceEvent> events);
+};
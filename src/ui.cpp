@@ -1,5 +1,7 @@
 ﻿#include "ui.h"
 #include "config.h"
+#include "modelDiff.h"
+#include "rebuildImpact.h"
 
 #include "ftxui/component/captured_mouse.hpp"      // for ftxui
 #include "ftxui/component/component.hpp"           // for Collapsible, Renderer, Vertical
@@ -8,6 +10,12 @@
 
 #include "collapsible-colorful.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <utility>
+
 class UI::MainWindow : public ftxui::ComponentBase
 {
     static ftxui::Component Prompt();
@@ -34,82 +42,573 @@ ftxui::Component UI::Empty()
     return std::make_shared<ftxui::ComponentBase>();
 }
 
-ftxui::Component UI::headerToComponent(const Model::Header& header)
+bool* UI::newExpandedFlag(bool isExpanded)
+{
+    m_isExpanded.push_back(isExpanded);
+    return &m_isExpanded.back();
+}
+
+void UI::addNode(const void* node, ftxui::Component component, bool* isExpanded, const void* parent)
+{
+    m_nodes[node] = NodeView{ std::move(component), isExpanded, parent };
+}
+
+ftxui::Color UI::headerColor(const Model::Header& header)
+{
+    ftxui::Color color = ftxui::Color::Default;
+    if (header.hasCycle())
+        color = k_colorHasCycle;
+    if (header.isCycle())
+        color = k_colorIsCycle;
+    if (header.isMatched())
+        color = k_colorIsMatch;    // #todo: highlight substring only
+
+    return color;
+}
+
+bool UI::hasTimes() const
+{
+    return !m_config.m_timeTrace.empty();
+}
+
+std::string UI::timeLabel(double ms) const
+{
+    if (!hasTimes())
+        return std::string();
+
+    char label[32];
+    std::snprintf(label, sizeof(label), "  [%.1f ms]", ms);
+    return label;
+}
+
+ftxui::Color UI::nodeColor(const Model::Header& header, double scaleMs) const
+{
+    ftxui::Color color = headerColor(header);
+    if (color != ftxui::Color::Default || !hasTimes() || header.inclusiveMs() <= 0 || scaleMs <= 0)
+        return color;
+
+    // most headers are a small share of the module, sqrt spreads them over the gradient
+    float share = static_cast<float>(std::sqrt(std::min(1.0, header.inclusiveMs() / scaleMs)));
+    return ftxui::Color::Interpolate(share, k_colorFast, k_colorSlow);
+}
+
+template <typename T, typename GetMs>
+std::vector<T*> UI::sortedByTime(std::vector<T*> items, GetMs getMs) const
 {
+    if (hasTimes())
+        std::stable_sort(items.begin(), items.end(), [&getMs](const T* left, const T* right) { return getMs(*left) > getMs(*right); });
+    return items;
+}
+
+ftxui::Component UI::headerToComponent(Model::Header& header, const void* parent)
+{
+    // matches of the initial --find were set during parsing, the search will reset them
+    if (header.isMatched() || header.hasMatch())
+        m_searchMarked.push_back(&header);
+    if (header.isMatched())
+        ++m_searchMatchCount;
+
     if (header.isLeaf())
     {
-        // no children, just text
-        auto leafComponent = ftxui::Renderer(
-            [name = header.name(),
-            hasCycle = header.hasCycle(),
-            isCycle = header.isCycle(),
-            isMatch = header.isMatched()](bool focused)
+        // no children, just text; traits are read on render as the search updates them
+        auto leafComponent = ftxui::Renderer([this, &header, time = timeLabel(header.inclusiveMs()), scaleMs = m_timeScaleMs](bool focused)
             {
-                ftxui::Element element = ftxui::text(name);
+                ftxui::Element element = ftxui::text(header.name() + time);
                 if (focused)
+                {
                     element = element | ftxui::inverted | ftxui::focus;
-                if (hasCycle)
-                    element = element | ftxui::color(k_colorHasCycle);
-                if (isCycle)
-                    element = element | ftxui::color(k_colorIsCycle);
-                if (isMatch)
-                    element = element | ftxui::color(k_colorIsMatch);     // #todo: highlight substring only
+                    m_focusedHeader = &header;
+                }
+                if (ftxui::Color color = nodeColor(header, scaleMs); color != ftxui::Color::Default)
+                    element = element | ftxui::color(color);
 
                 return element;
             });
 
+        addNode(&header, leafComponent, nullptr, parent);
         return leafComponent;
     }
 
     // has children, collapsible
-    ftxui::Components children;
-    children.reserve(header.children().size());
-    for (const Model::Header& child : header.children())
-        children.push_back(headerToComponent(child));
+    std::vector<Model::Header*> sortedChildren;
+    sortedChildren.reserve(header.children().size());
+    for (Model::Header& child : header.children())
+        sortedChildren.push_back(&child);
 
-    ftxui::Color color = ftxui::Color::Default;
-    if (header.hasCycle())
-        color = k_colorHasCycle;
-    if (header.isCycle())
-        color = k_colorIsCycle;
-    if (header.isMatched())
-        color = k_colorIsMatch;    // #todo: highlight substring only
+    ftxui::Components children;
+    children.reserve(sortedChildren.size());
+    for (Model::Header* child : sortedByTime(std::move(sortedChildren), std::mem_fn(&Model::Header::inclusiveMs)))
+        children.push_back(headerToComponent(*child, &header));
 
-    bool autoExpand = m_config.m_autoExpand && (header.hasCycle() || header.isCycle())
+    bool autoExpand = (m_config.m_autoExpand && (header.hasCycle() || header.isCycle()))
         || header.isMatched() || header.hasMatch();
-    return CollapsibleColorful(header.name(), Inner(children), color, autoExpand);
+    bool* isExpanded = newExpandedFlag(autoExpand);
+    auto component = CollapsibleColorful(header.name() + timeLabel(header.inclusiveMs()), Inner(children),
+                                         [this, &header, scaleMs = m_timeScaleMs] { return nodeColor(header, scaleMs); }, isExpanded,
+                                         [this, &header] { m_focusedHeader = &header; });
+
+    addNode(&header, component, isExpanded, parent);
+    return component;
 }
 
-ftxui::Component UI::moduleToComponent(const Model::Module& unit)
+ftxui::Component UI::moduleToComponent(Model::Module& unit, const Model::Project& project)
 {
+    std::vector<Model::Header*> sortedHeaders;
+    sortedHeaders.reserve(unit.headers().size());
+    for (Model::Header& header : unit.headers())
+        sortedHeaders.push_back(&header);
+
+    m_timeScaleMs = unit.inclusiveMs();
     ftxui::Components headers;
-    headers.reserve(unit.headers().size());
-    for (const Model::Header& header : unit.headers())
-        headers.push_back(headerToComponent(header));
+    headers.reserve(sortedHeaders.size());
+    for (Model::Header* header : sortedByTime(std::move(sortedHeaders), std::mem_fn(&Model::Header::inclusiveMs)))
+        headers.push_back(headerToComponent(*header, &unit));
 
-    bool autoExpand = m_config.m_autoExpand && unit.hasCycle();
-    return Collapsible(unit.name(), Inner(headers), autoExpand);
+    bool* isExpanded = newExpandedFlag(m_config.m_autoExpand && unit.hasCycle());
+    auto component = Collapsible(unit.name() + timeLabel(unit.inclusiveMs()), Inner(headers), isExpanded);
+
+    addNode(&unit, component, isExpanded, &project);
+    return component;
 }
 
-ftxui::Component UI::projectToComponent(const Model::Project& project)
+ftxui::Component UI::projectToComponent(Model::Project& project)
 {
+    std::vector<Model::Module*> sortedModules;
+    double projectMs = 0;
+    for (auto& [name, unit] : project.modules())
+    {
+        sortedModules.push_back(&unit);
+        projectMs += unit.inclusiveMs();
+    }
+
     ftxui::Components modules;
     bool autoExpand = false;
-    for (const auto& [name, unit] : project.modules())
+    for (Model::Module* unit : sortedByTime(std::move(sortedModules), std::mem_fn(&Model::Module::inclusiveMs)))
     {
-        autoExpand = autoExpand || (m_config.m_autoExpand && unit.hasCycle());
-        modules.push_back(moduleToComponent(unit));
+        autoExpand = autoExpand || (m_config.m_autoExpand && unit->hasCycle());
+        modules.push_back(moduleToComponent(*unit, project));
     }
 
-    return Collapsible(project.name(), Inner(modules), autoExpand);
+    bool* isExpanded = newExpandedFlag(autoExpand);
+    auto component = Collapsible(project.name() + timeLabel(projectMs), Inner(modules), isExpanded);
+
+    addNode(&project, component, isExpanded, nullptr);
+    return component;
 }
 
-ftxui::Component UI::modelToComponent(const Model& solution)
+ftxui::Component UI::modelToComponent(Model& solution)
 {
     auto container = ftxui::Container::Vertical({});
-    for (const auto& [_, project] : solution.projects())
+    for (auto& [_, project] : solution.projects())
         container->Add(projectToComponent(project));
 
+    m_treeContainer = container;
+
+    auto renderer = ftxui::Renderer(container, [=, this] {
+        m_focusedHeader = nullptr;  // focused node will set it while rendering
+        return container->Render()
+            | ftxui::vscroll_indicator | ftxui::frame | ftxui::border;
+        });
+
+    return renderer;
+}
+
+ftxui::Component UI::jumpListToComponent()
+{
+    ftxui::MenuOption option = ftxui::MenuOption::Vertical();
+    option.on_enter = [this]
+        {
+            m_showJumpList = false;
+            if (m_jumpListSelected >= 0 && m_jumpListSelected < static_cast<int>(m_jumpListTargets.size()))
+                jumpTo(*m_jumpListTargets[m_jumpListSelected]);
+        };
+
+    auto menu = ftxui::Menu(&m_jumpListLabels, &m_jumpListSelected, option);
+    return ftxui::Renderer(menu, [this, menu]
+        {
+            return ftxui::window(ftxui::text(m_jumpListTitle),
+                menu->Render() | ftxui::vscroll_indicator | ftxui::frame | ftxui::size(ftxui::HEIGHT, ftxui::LESS_THAN, 20));
+        });
+}
+
+void UI::showIncluders(const Model& solution, const Model::Header& header)
+{
+    const std::vector<Model::Includer>& includers = solution.includers(header.id());
+
+    m_jumpListTitle = header.name() + " - included " + std::to_string(includers.size()) + " time(s)";
+    m_jumpListLabels.clear();
+    m_jumpListTargets.clear();
+    for (const Model::Includer& includer : includers)
+    {
+        m_jumpListLabels.push_back(includer.m_project->name() + " / " + includer.m_module->name()
+            + ": " + (includer.m_parent ? includer.m_parent->name() : includer.m_module->name()));
+        m_jumpListTargets.push_back(includer.m_header);
+    }
+
+    m_jumpListSelected = 0;
+    m_showJumpList = true;
+}
+
+void UI::showRebuildImpact(const Model& solution)
+{
+    static constexpr std::size_t k_maxProjectsInLabel = 3;
+
+    RebuildImpact impact = RebuildImpact(solution);
+    const std::vector<RebuildImpact::Impact>& ranking = impact.ranking();
+
+    m_jumpListTitle = "Modules to rebuild when a header changes, of " + std::to_string(impact.moduleCount())
+        + (m_isLoading ? " loaded so far" : "");
+    m_jumpListLabels.clear();
+    m_jumpListTargets.clear();
+    for (std::size_t i = 0; i < std::min(ranking.size(), m_config.m_top); ++i)
+    {
+        char count[16];
+        std::snprintf(count, sizeof(count), "%6zu  ", ranking[i].m_moduleCount);
+
+        std::string projects;
+        std::vector<RebuildImpact::ProjectImpact> byProject = impact.byProject(ranking[i]);
+        for (std::size_t j = 0; j < std::min(byProject.size(), k_maxProjectsInLabel); ++j)
+            projects += (j ? ", " : "  [") + byProject[j].m_project->name() + ": " + std::to_string(byProject[j].m_moduleCount);
+        if (!byProject.empty())
+            projects += byProject.size() > k_maxProjectsInLabel ? ", ...]" : "]";
+
+        m_jumpListLabels.push_back(count + ranking[i].m_header->name() + projects);
+        m_jumpListTargets.push_back(ranking[i].m_header);
+    }
+
+    m_jumpListSelected = 0;
+    m_showJumpList = true;
+}
+
+void UI::jumpTo(const Model::Header& header)
+{
+    auto it = m_nodes.find(&header);
+    if (it == m_nodes.end())
+        return;
+
+    for (const void* parent = it->second.m_parent; parent; )
+    {
+        const NodeView& parentView = m_nodes.at(parent);
+        if (parentView.m_isExpanded)
+            *parentView.m_isExpanded = true;
+        parent = parentView.m_parent;
+    }
+
+    // focus the label of a collapsible header, not its last active child
+    const NodeView& view = it->second;
+    if (view.m_isExpanded)
+        view.m_component->ChildAt(0)->ChildAt(0)->TakeFocus();
+    else
+        view.m_component->TakeFocus();
+}
+
+void UI::expand(const void* node)
+{
+    if (auto it = m_nodes.find(node); it != m_nodes.end() && it->second.m_isExpanded)
+        *it->second.m_isExpanded = true;
+}
+
+ftxui::Component UI::searchToComponent()
+{
+    ftxui::InputOption option;
+    option.multiline = false;
+    option.on_change = [this] { startSearch(); };
+    option.on_enter = [this] { m_tree->TakeFocus(); };
+
+    m_searchInput = ftxui::Input(&m_searchQuery, "type to search, '/' to focus", option);
+    return ftxui::Renderer(m_searchInput, [this]
+        {
+            std::string status = m_searchQuery.empty() ? std::string()
+                : std::to_string(m_searchMatchCount) + " match(es)" + (m_isSearching ? ", searching..." : "");
+
+            return ftxui::hbox({
+                ftxui::text("Search: ") | ftxui::bold,
+                m_searchInput->Render() | ftxui::flex,
+                ftxui::text(status) | ftxui::color(k_colorIsMatch),
+                });
+        });
+}
+
+ftxui::Component UI::progressToComponent()
+{
+    return ftxui::Renderer([this]
+        {
+            if (!m_loadingError.empty())
+                return ftxui::text(m_loadingError) | ftxui::color(ftxui::Color::Red);
+            if (!m_isLoading)
+                return ftxui::emptyElement();
+
+            constexpr double megabyte = 1024.0 * 1024.0;
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_loadingStart).count();
+            double throughput = seconds > 0 ? m_bytesParsed / megabyte / seconds : 0.0;
+            float ratio = m_totalBytes ? static_cast<float>(m_bytesParsed) / m_totalBytes : 0.0f;
+
+            char status[64];
+            std::snprintf(status, sizeof(status), " %.1f / %.1f MB, %.1f MB/s", m_bytesParsed / megabyte, m_totalBytes / megabyte, throughput);
+            return ftxui::hbox({
+                ftxui::text("Parsing: ") | ftxui::bold,
+                ftxui::gauge(ratio) | ftxui::flex,
+                ftxui::text(status),
+                });
+        });
+}
+
+void UI::addProject(Model::Project& project)
+{
+    std::size_t firstMarked = m_searchMarked.size();
+    m_treeContainer->Add(projectToComponent(project));
+
+    // parse-time matches are only valid for the initial --find, the query may have been edited since
+    if (normalizedSearchQuery() == m_config.m_findNormalized)
+        return;
+
+    for (std::size_t i = firstMarked; i < m_searchMarked.size(); ++i)
+    {
+        if (m_searchMarked[i]->isMatched())
+            --m_searchMatchCount;
+        m_searchMarked[i]->clearMatch();
+    }
+
+    m_searchMarked.resize(firstMarked);
+    searchProjects({ &project });
+}
+
+void UI::setProgress(std::uintmax_t bytesParsed, std::uintmax_t totalBytes)
+{
+    if (!m_isLoading)
+    {
+        m_isLoading = true;
+        m_loadingStart = std::chrono::steady_clock::now();
+    }
+
+    m_bytesParsed = bytesParsed;
+    m_totalBytes = totalBytes;
+}
+
+void UI::finishLoading(const std::string& error)
+{
+    m_isLoading = false;
+    if (m_loadingError.empty())     // the first error is the cause, keep it
+        m_loadingError = error;
+}
+
+std::string UI::normalizedSearchQuery() const
+{
+    std::string query = m_searchQuery;
+    std::transform(query.begin(), query.end(), query.begin(), &Model::normalizePathChar);
+    return query;
+}
+
+void UI::startSearch()
+{
+    ++m_searchGeneration;
+    m_searchThread = std::jthread();    // requests stop of the stale query and joins it
+    clearSearch();
+
+    std::vector<Model::Project*> projects;
+    for (auto& [_, project] : m_model->projects())
+        projects.push_back(&project);
+
+    searchProjects(projects);
+}
+
+void UI::clearSearch()
+{
+    for (Model::Header* header : m_searchMarked)
+        header->clearMatch();
+
+    m_searchMarked.clear();
+    m_searchBacklog.clear();
+    m_searchMatchCount = 0;
+    m_isSearching = false;
+}
+
+void UI::searchProjects(const std::vector<Model::Project*>& projects)
+{
+    m_searchBacklog.insert(m_searchBacklog.end(), projects.begin(), projects.end());
+    if (!m_isSearching)
+        runSearchBacklog();
+}
+
+void UI::runSearchBacklog()
+{
+    std::string query = normalizedSearchQuery();
+    m_isSearching = !query.empty() && !m_searchBacklog.empty();
+    if (!m_isSearching)
+    {
+        m_searchBacklog.clear();
+        return;
+    }
+
+    // the previous worker, if any, has posted its final results and is about to exit
+    m_searchThread = std::jthread([this, generation = m_searchGeneration, query, projects = std::exchange(m_searchBacklog, {})](std::stop_token stopToken)
+        {
+            searchModel(stopToken, generation, query, projects);
+        });
+}
+
+void UI::searchModel(std::stop_token stopToken, unsigned generation, const std::string& query, const std::vector<Model::Project*>& projects)
+{
+    // runs on the worker thread: reads only names and children, all trait updates are posted to the UI thread
+    struct Frame
+    {
+        Model::Header* m_header;
+        std::size_t m_nextChild;
+    };
+
+    SearchResults results;
+    auto post = [&](bool isFinal)
+        {
+            results.m_isFinal = isFinal;
+            m_screen->Post([this, generation, query, results = std::move(results)] { applySearchResults(generation, query, results); });
+            results = SearchResults();
+        };
+
+    std::vector<Frame> stack;
+    std::size_t visited = 0;
+    for (Model::Project* project : projects)
+    {
+        for (auto& [_, unit] : project->modules())
+        {
+            bool isModuleReported = false;
+            for (Model::Header& root : unit.headers())
+            {
+                std::size_t reportedAncestors = 0;
+                stack.assign(1, Frame{ &root, 0 });
+                while (!stack.empty())
+                {
+                    Frame& frame = stack.back();
+                    if (frame.m_nextChild == 0)
+                    {
+                        // entering the node
+                        if ((++visited & 0xfff) == 0 && stopToken.stop_requested())
+                            return;
+
+                        if (frame.m_header->normalizedName().find(query) != std::string::npos)
+                        {
+                            results.m_matched.push_back(frame.m_header);
+                            for (; reportedAncestors + 1 < stack.size(); ++reportedAncestors)
+                                results.m_hasMatch.push_back(stack[reportedAncestors].m_header);
+
+                            if (!isModuleReported)
+                            {
+                                results.m_containers.push_back(project);
+                                results.m_containers.push_back(&unit);
+                                isModuleReported = true;
+                            }
+
+                            if (results.m_matched.size() >= k_searchBatchSize)
+                                post(false);
+                        }
+                    }
+
+                    std::vector<Model::Header>& children = frame.m_header->children();
+                    if (frame.m_nextChild < children.size())
+                    {
+                        Model::Header* child = &children[frame.m_nextChild++];
+                        stack.push_back(Frame{ child, 0 });
+                    }
+                    else
+                    {
+                        stack.pop_back();
+                        reportedAncestors = std::min(reportedAncestors, stack.size());
+                    }
+                }
+            }
+        }
+    }
+
+    post(true);
+}
+
+void UI::applySearchResults(unsigned generation, const std::string& query, const SearchResults& results)
+{
+    if (generation != m_searchGeneration)
+        return;
+
+    for (Model::Header* header : results.m_matched)
+    {
+        header->tryMatch(query);
+        m_searchMarked.push_back(header);
+        expand(header);
+    }
+
+    for (Model::Header* header : results.m_hasMatch)
+    {
+        header->setHasMatch();
+        m_searchMarked.push_back(header);
+        expand(header);
+    }
+
+    for (const void* container : results.m_containers)
+        expand(container);
+
+    m_searchMatchCount += results.m_matched.size();
+    if (results.m_isFinal)
+    {
+        m_isSearching = false;
+        runSearchBacklog();
+    }
+}
+
+ftxui::Component UI::diffToComponent(const ModelDiff& diff)
+{
+    auto edgeToComponent = [](const ModelDiff::Edge& edge, bool isAdded)
+        {
+            std::string label = std::string(isAdded ? "+ " : "- ")
+                + (edge.m_parent.empty() ? std::string() : edge.m_parent + " -> ")
+                + edge.m_child + " (" + std::to_string(edge.m_subtreeSize) + ")";
+
+            return ftxui::Renderer([label, isAdded](bool focused)
+                {
+                    ftxui::Element element = ftxui::text(label) | ftxui::color(isAdded ? k_colorAdded : k_colorRemoved);
+                    if (focused)
+                        element = element | ftxui::inverted | ftxui::focus;
+                    return element;
+                });
+        };
+
+    auto container = ftxui::Container::Vertical({});
+    ftxui::Components modules;
+    auto flushProject = [&](const std::string& projectName)
+        {
+            if (!modules.empty())
+                container->Add(Collapsible(projectName, Inner(std::move(modules))));
+            modules.clear();
+        };
+
+    for (size_t i = 0; i < diff.modules().size(); ++i)
+    {
+        const ModelDiff::ModuleDiff& unit = diff.modules()[i];
+
+        ftxui::Components edges;
+        edges.reserve(unit.m_added.size() + unit.m_removed.size());
+        for (const ModelDiff::Edge& edge : unit.m_added)
+            edges.push_back(edgeToComponent(edge, true));
+        for (const ModelDiff::Edge& edge : unit.m_removed)
+            edges.push_back(edgeToComponent(edge, false));
+
+        std::string label = unit.m_module
+            + "  +" + std::to_string(unit.m_added.size())
+            + " -" + std::to_string(unit.m_removed.size())
+            + "  includes: " + (unit.m_includeCountDelta > 0 ? "+" : "") + std::to_string(unit.m_includeCountDelta);
+
+        ftxui::Color color = ftxui::Color::Default;
+        if (unit.m_status == ModelDiff::Status::Added)
+            color = k_colorAdded;
+        if (unit.m_status == ModelDiff::Status::Removed)
+            color = k_colorRemoved;
+
+        modules.push_back(CollapsibleColorful(label, Inner(std::move(edges)), [color] { return color; }));
+
+        bool isLastInProject = i + 1 == diff.modules().size() || diff.modules()[i + 1].m_project != unit.m_project;
+        if (isLastInProject)
+            flushProject(unit.m_project);
+    }
+
+    if (diff.isEmpty())
+        container->Add(ftxui::Renderer([] { return ftxui::text("No include differences"); }));
+
     auto renderer = ftxui::Renderer(container, [=] {
         return container->Render()
             | ftxui::vscroll_indicator | ftxui::frame | ftxui::border;
@@ -123,9 +622,60 @@ UI::UI(const Config& c) : m_config(c)
 
 }
 
-ftxui::Component UI::make(const Model& solution)
+ftxui::Component UI::make(Model& solution, ftxui::ScreenInteractive& screen)
 {
-    return std::make_shared<MainWindow>(modelToComponent(solution));
+    m_model = &solution;
+    m_screen = &screen;
+    m_searchQuery = m_config.m_findNormalized;
+
+    m_tree = modelToComponent(solution);
+    auto layout = ftxui::Container::Vertical({ m_tree, searchToComponent(), progressToComponent() });
+    auto withJumpList = ftxui::Modal(layout, jumpListToComponent(), &m_showJumpList);
+    auto withShortcuts = ftxui::CatchEvent(withJumpList, [this, &solution](ftxui::Event event)
+        {
+            if (m_showJumpList && event == ftxui::Event::Escape)
+            {
+                m_showJumpList = false;
+                return true;
+            }
+
+            if (m_searchInput->Focused())
+            {
+                if (event == ftxui::Event::Escape)
+                {
+                    m_tree->TakeFocus();
+                    return true;
+                }
+                return false;   // let the input have every character
+            }
+
+            if (!m_showJumpList && event == ftxui::Event::Character('/'))
+            {
+                m_searchInput->TakeFocus();
+                return true;
+            }
+
+            if (!m_showJumpList && event == ftxui::Event::Character('i') && m_focusedHeader)
+            {
+                showIncluders(solution, *m_focusedHeader);
+                return true;
+            }
+
+            if (!m_showJumpList && event == ftxui::Event::Character('r'))
+            {
+                showRebuildImpact(solution);
+                return true;
+            }
+
+            return false;
+        });
+
+    return std::make_shared<MainWindow>(withShortcuts);
+}
+
+ftxui::Component UI::make(const ModelDiff& diff)
+{
+    return std::make_shared<MainWindow>(diffToComponent(diff));
 }
 
 ftxui::Component UI::MainWindow::Prompt()
@@ -135,6 +685,12 @@ ftxui::Component UI::MainWindow::Prompt()
             return ftxui::hbox({
                 ftxui::text("↑↓ ⏎ ␣") | ftxui::bold,
                 ftxui::text(" - navigate; "),
+                ftxui::text("/") | ftxui::bold,
+                ftxui::text(" - search; "),
+                ftxui::text("i") | ftxui::bold,
+                ftxui::text(" - included by; "),
+                ftxui::text("r") | ftxui::bold,
+                ftxui::text(" - rebuild impact; "),
                 ftxui::text("q") | ftxui::bold,
                 ftxui::text(" - quit;"),
                 });
@@ -151,6 +707,10 @@ UI::MainWindow::MainWindow(ftxui::Component child)
 
 bool UI::MainWindow::OnEvent(ftxui::Event event)
 {
+    // children first: 'q' typed into the search box is not a quit
+    if (ftxui::ComponentBase::OnEvent(event))
+        return true;
+
     if (event == ftxui::Event::Character('q'))
     {
         if (auto screen = ftxui::ScreenInteractive::Active())
@@ -158,5 +718,5 @@ bool UI::MainWindow::OnEvent(ftxui::Event event)
         return true;
     }
 
-    return ftxui::ComponentBase::OnEvent(event);
+    return false;
 }
@@ -3,29 +3,127 @@
 #include "ftxui/component/component_base.hpp"      // for ComponentBase
 #include "model.h"
 
+#include <chrono>
+#include <deque>
+#include <stop_token>
+#include <thread>
+#include <unordered_map>
+
+namespace ftxui { class ScreenInteractive; }
+
 static const ftxui::Color k_colorHasCycle = ftxui::Color::Yellow;
 static const ftxui::Color k_colorIsCycle = ftxui::Color::Red;
 static const ftxui::Color k_colorIsMatch = ftxui::Color::Blue;
+static const ftxui::Color k_colorAdded = ftxui::Color::Green;
+static const ftxui::Color k_colorRemoved = ftxui::Color::Red;
+static const ftxui::Color k_colorFast = ftxui::Color::Green;     // time gradient, from a negligible share of the module...
+static const ftxui::Color k_colorSlow = ftxui::Color::Magenta;  // ... to the whole module time
 
 struct Config;
+class ModelDiff;
 
 class UI
 {
+    // tree node of a project, module or header; key is the address of the model object
+    struct NodeView
+    {
+        ftxui::Component m_component;
+        bool* m_isExpanded = nullptr;       // nullptr for leaves
+        const void* m_parent = nullptr;
+    };
+
+    // chunk of matches streamed from the search worker to the UI thread
+    struct SearchResults
+    {
+        std::vector<Model::Header*> m_matched;
+        std::vector<Model::Header*> m_hasMatch;     // ancestors of matches, not reported before
+        std::vector<const void*> m_containers;      // modules and projects to expand
+        bool m_isFinal = false;
+    };
+
+    static constexpr std::size_t k_searchBatchSize = 256;
+
     const Config& m_config;
+    Model* m_model = nullptr;
+    ftxui::ScreenInteractive* m_screen = nullptr;
+
+    std::unordered_map<const void*, NodeView> m_nodes;
+    std::deque<bool> m_isExpanded;          // storage for NodeView::m_isExpanded, addresses are stable
+    const Model::Header* m_focusedHeader = nullptr;
+    double m_timeScaleMs = 0;               // time of the module being built, full scale of the time gradient
+
+    // modal list of headers to jump to: includers of a header, or the rebuild impact ranking
+    bool m_showJumpList = false;
+    std::string m_jumpListTitle;
+    std::vector<std::string> m_jumpListLabels;
+    std::vector<const Model::Header*> m_jumpListTargets;
+    int m_jumpListSelected = 0;
+
+    ftxui::Component m_tree;
+    ftxui::Component m_treeContainer;   // project list, grows while the log is parsed
+
+    bool m_isLoading = false;
+    std::uintmax_t m_bytesParsed = 0;
+    std::uintmax_t m_totalBytes = 0;
+    std::chrono::steady_clock::time_point m_loadingStart;
+    std::string m_loadingError;
+
+    ftxui::Component m_searchInput;
+    std::string m_searchQuery;
+    unsigned m_searchGeneration = 0;                // results of older generations are stale
+    std::vector<Model::Header*> m_searchMarked;     // headers with IsMatched/HasMatch set by the search
+    std::vector<Model::Project*> m_searchBacklog;   // projects to search when the running worker is done
+    std::size_t m_searchMatchCount = 0;
+    bool m_isSearching = false;
+    std::jthread m_searchThread;    // last data member: joined before the state it posts to is destroyed
 
     class MainWindow;
     static ftxui::Component Inner(std::vector<ftxui::Component> children);
     static ftxui::Component Empty();
 
-    ftxui::Component headerToComponent(const Model::Header& header);
-    ftxui::Component moduleToComponent(const Model::Module& unit);
-    ftxui::Component projectToComponent(const Model::Project& project);
-    ftxui::Component modelToComponent(const Model& solution);
+    bool* newExpandedFlag(bool isExpanded);
+    void addNode(const void* node, ftxui::Component component, bool* isExpanded, const void* parent);
+
+    static ftxui::Color headerColor(const Model::Header& header);
+
+    bool hasTimes() const;
+    std::string timeLabel(double ms) const;
+    ftxui::Color nodeColor(const Model::Header& header, double scaleMs) const;
+    template <typename T, typename GetMs>
+    std::vector<T*> sortedByTime(std::vector<T*> items, GetMs getMs) const;
+
+    ftxui::Component headerToComponent(Model::Header& header, const void* parent);
+    ftxui::Component moduleToComponent(Model::Module& unit, const Model::Project& project);
+    ftxui::Component projectToComponent(Model::Project& project);
+    ftxui::Component modelToComponent(Model& solution);
+    ftxui::Component diffToComponent(const ModelDiff& diff);
+    ftxui::Component jumpListToComponent();
+    ftxui::Component searchToComponent();
+    ftxui::Component progressToComponent();
+
+    void showIncluders(const Model& solution, const Model::Header& header);
+    void showRebuildImpact(const Model& solution);
+    void jumpTo(const Model::Header& header);
+    void expand(const void* node);
+
+    std::string normalizedSearchQuery() const;
+    void startSearch();
+    void clearSearch();
+    void searchProjects(const std::vector<Model::Project*>& projects);
+    void runSearchBacklog();
+    void searchModel(std::stop_token stopToken, unsigned generation, const std::string& query, const std::vector<Model::Project*>& projects);
+    void applySearchResults(unsigned generation, const std::string& query, const SearchResults& results);
 
 public:
     UI(const Config& c);
 
-    ftxui::Component make(const Model& solution);
+    ftxui::Component make(Model& solution, ftxui::ScreenInteractive& screen);
+
+    // progressive loading, all called on the UI thread
+    void addProject(Model::Project& project);
+    void setProgress(std::uintmax_t bytesParsed, std::uintmax_t totalBytes);
+    void finishLoading(const std::string& error);
+    ftxui::Component make(const ModelDiff& diff);
 };
 
 